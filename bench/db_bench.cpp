@@ -0,0 +1,186 @@
+// Micro-benchmarks for the Database layer: db_bench [rows]
+//
+// Runs against a throwaway database under Qt's test-mode data directory,
+// so the real taskmanager.db is never touched.
+#include "database.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QSqlQuery>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <cstdio>
+#include <functional>
+
+namespace {
+    void report(const char* name, qint64 rows, double elapsedMs) {
+        const double perSecond = elapsedMs > 0 ? rows * 1000.0 / elapsedMs : 0.0;
+        std::printf("%-44s %8lld rows %10.1f ms %12.0f rows/s\n",
+                    name, static_cast<long long>(rows), elapsedMs, perSecond);
+    }
+
+    double elapsedMs(const QElapsedTimer& timer) {
+        return timer.nsecsElapsed() / 1e6;
+    }
+
+    // Times two variants of one job. Each runs once untimed to warm up,
+    // then they run A B B A and each reports the mean of its two runs, so
+    // neither variant always goes first.
+    void compare(const char* nameA, const char* nameB, qint64 rows,
+                 const std::function<double(bool variantB)>& job) {
+        job(false);
+        job(true);
+        double a = job(false);
+        double b = job(true);
+        b += job(true);
+        a += job(false);
+        report(nameA, rows, a / 2);
+        report(nameB, rows, b / 2);
+    }
+
+    // createTask over fresh rows, in one transaction so the time goes into
+    // statement handling rather than commits
+    double createTasks(int rows, bool cached) {
+        QSqlDatabase db = QSqlDatabase::database();
+        QSqlQuery clear(db);
+        clear.exec("DELETE FROM tasks");
+
+        Database::setStatementCacheEnabled(cached);
+        const QDateTime start = QDateTime::currentDateTime();
+        QElapsedTimer timer;
+        db.transaction();
+        timer.start();
+        for (int i = 0; i < rows; ++i) {
+            Task task;
+            task.title = QString("Task %1").arg(i);
+            task.description = "Benchmark row";
+            task.deadline = start.addSecs(i * 60);
+            task.priority = i % 4;
+            Database::createTask(task);
+        }
+        const double elapsed = elapsedMs(timer);
+        db.commit();
+        Database::setStatementCacheEnabled(true);
+        return elapsed;
+    }
+
+    double updateTasks(bool cached) {
+        QSqlDatabase db = QSqlDatabase::database();
+        QVector<Task> tasks = Database::getAllTasks();
+
+        Database::setStatementCacheEnabled(cached);
+        QElapsedTimer timer;
+        db.transaction();
+        timer.start();
+        for (Task& task : tasks) {
+            task.isCompleted = !task.isCompleted;
+            Database::updateTask(task);
+        }
+        const double elapsed = elapsedMs(timer);
+        db.commit();
+        Database::setStatementCacheEnabled(true);
+        return elapsed;
+    }
+
+    // Decodes every task the way the readers used to (SELECT *, scrollable
+    // cursor, lookups by column name) or the way they do now
+    double decodeTasks(int rows, bool byOrdinal) {
+        QVector<Task> tasks;
+        QSqlQuery query(QSqlDatabase::database());
+        QElapsedTimer timer;
+        timer.start();
+        if (byOrdinal) {
+            tasks.reserve(rows);
+            query.setForwardOnly(true);
+            query.exec("SELECT id, title, description, deadline, priority, is_completed FROM tasks");
+            while (query.next()) {
+                Task task;
+                task.id = query.value(0).toInt();
+                task.title = query.value(1).toString();
+                task.description = query.value(2).toString();
+                task.deadline = query.value(3).toDateTime();
+                task.priority = query.value(4).toInt();
+                task.isCompleted = query.value(5).toBool();
+                tasks.append(task);
+            }
+        } else {
+            query.exec("SELECT * FROM tasks");
+            while (query.next()) {
+                Task task;
+                task.id = query.value("id").toInt();
+                task.title = query.value("title").toString();
+                task.description = query.value("description").toString();
+                task.deadline = query.value("deadline").toDateTime();
+                task.priority = query.value("priority").toInt();
+                task.isCompleted = query.value("is_completed").toBool();
+                tasks.append(task);
+            }
+        }
+        return elapsedMs(timer);
+    }
+
+    // Round-trips the database through the SQL dump and the binary snapshot
+    void benchTransfers(int rows, const QString& directory) {
+        const QString sqlPath = directory + "/bench.sql";
+        const QString snapshotPath = directory + "/bench.tmsnap";
+
+        compare("exportToSQL", "exportSnapshot", rows, [&](bool snapshot) {
+            QElapsedTimer timer;
+            timer.start();
+            if (snapshot) {
+                Database::exportSnapshot(snapshotPath);
+            } else {
+                Database::exportToSQL(sqlPath);
+            }
+            return elapsedMs(timer);
+        });
+        compare("importFromSQL (replay)", "importSnapshot", rows, [&](bool snapshot) {
+            QElapsedTimer timer;
+            timer.start();
+            if (snapshot) {
+                Database::importSnapshot(snapshotPath);
+            } else {
+                Database::importFromSQL(sqlPath);
+            }
+            return elapsedMs(timer);
+        });
+    }
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication app(argc, argv);
+    QStandardPaths::setTestModeEnabled(true);
+
+    const int rows = argc > 1 ? QString(argv[1]).toInt() : 100000;
+    if (rows <= 0) {
+        std::fprintf(stderr, "usage: db_bench [rows]\n");
+        return 1;
+    }
+
+    const QString path = Database::getDatabasePath();
+    QFile::remove(path);
+    if (!Database::initialize()) {
+        return 1;
+    }
+
+    compare("createTask, prepared per call", "createTask, cached statements", rows,
+            [rows](bool cached) { return createTasks(rows, cached); });
+    compare("updateTask, prepared per call", "updateTask, cached statements", rows,
+            [](bool cached) { return updateTasks(cached); });
+    compare("decode by column name, scrollable", "decode by ordinal, forward-only", rows,
+            [rows](bool byOrdinal) { return decodeTasks(rows, byOrdinal); });
+
+    QElapsedTimer timer;
+    timer.start();
+    const QVector<Task> tasks = Database::getAllTasks();
+    report("Database::getAllTasks", tasks.size(), elapsedMs(timer));
+
+    QTemporaryDir transferDir;
+    benchTransfers(rows, transferDir.path());
+
+    Database::shutdown();
+    for (const QString& suffix : {"", "-wal", "-shm"}) {
+        QFile::remove(path + suffix);
+    }
+    return 0;
+}
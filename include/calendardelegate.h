@@ -2,12 +2,22 @@
 #include <QStyledItemDelegate>
 #include <QDate>
 #include <QMap>
+#include "task.h"
 
 class CalendarDelegate : public QStyledItemDelegate {
 public:
-    CalendarDelegate(QMap<QDate, QStringList> tasks, QObject* parent = nullptr)
+    CalendarDelegate(QMap<QDate, TaskDaySummary> tasks, QObject* parent = nullptr)
         : QStyledItemDelegate(parent), m_tasks(tasks) {}
 
+    void setTasks(const QMap<QDate, TaskDaySummary>& tasks) { m_tasks = tasks; }
+    void setDay(const QDate& date, const TaskDaySummary& day) {
+        if (day.openCount > 0) {
+            m_tasks.insert(date, day);
+        } else {
+            m_tasks.remove(date);
+        }
+    }
+
     void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override {
         QStyledItemDelegate::paint(painter, option, index);
 
@@ -16,7 +26,8 @@ public:
 
         // Draw task indicators
         if (m_tasks.contains(date)) {
-            const QStringList& tasks = m_tasks[date];
+            const TaskDaySummary& day = m_tasks[date];
+            const QStringList& tasks = day.titles;
             
             // Draw background for days with tasks
             painter->save();
@@ -36,8 +47,8 @@ public:
             // Draw up to 3 task titles
             for (int i = 0; i < qMin(3, tasks.size()); i++) {
                 QString task = tasks[i];
-                if (i == 2 && tasks.size() > 3) {
-                    task = QString("+%1 more").arg(tasks.size() - 2);
+                if (i == 2 && day.openCount > 3) {
+                    task = QString("+%1 more").arg(day.openCount - 2);
                 }
                 
                 QTextOption textOption;
@@ -53,5 +64,5 @@ public:
     }
 
 private:
-    QMap<QDate, QStringList> m_tasks;
+    QMap<QDate, TaskDaySummary> m_tasks;
 };
\ No newline at end of file
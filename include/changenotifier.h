@@ -0,0 +1,52 @@
+#pragma once
+#include <QObject>
+#include <QMetaType>
+#include "task.h"
+
+// Announces successful writes made through the Database functions, so each
+// view can subscribe to just the data it shows instead of reloading
+// everything after every slot. Writes on the worker thread emit there too;
+// receivers in the GUI thread get those queued.
+class ChangeNotifier : public QObject {
+    Q_OBJECT
+public:
+    enum TaskField {
+        Title       = 0x01,
+        Description = 0x02,
+        Deadline    = 0x04,
+        Priority    = 0x08,
+        Completed   = 0x10
+    };
+    Q_DECLARE_FLAGS(TaskFields, TaskField)
+    Q_FLAG(TaskFields)
+
+    static ChangeNotifier* instance();
+    static TaskFields changedFields(const Task& before, const Task& after);
+
+signals:
+    // Task events carry the rows, so receivers don't read them back
+    void taskInserted(const Task& task);
+    void taskUpdated(const Task& before, const Task& after, ChangeNotifier::TaskFields changed);
+    void taskDeleted(const Task& task);
+    void tasksReset(); // many tasks at once, e.g. archiving
+
+    void todoListInserted(int id);
+    void todoListUpdated(int id);
+    void todoListDeleted(int id); // its items go with it
+    void todoItemInserted(int id);
+    void todoItemUpdated(int id);
+    void todoItemDeleted(int id);
+
+    void templateInserted(int id);
+    void templateUpdated(int id); // items added or removed
+    void templateDeleted(int id);
+
+    // Every table may have changed: restore and imports
+    void dataReset();
+
+private:
+    explicit ChangeNotifier(QObject* parent = nullptr);
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(ChangeNotifier::TaskFields)
+Q_DECLARE_METATYPE(Task)
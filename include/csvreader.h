@@ -0,0 +1,33 @@
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <QTextStream>
+#include <QVariantList>
+
+class QIODevice;
+
+// Reads RFC 4180 CSV record by record from a stream, in bounded memory.
+// Quoted fields may contain commas, doubled quotes and line breaks. An
+// empty unquoted field reads as NULL, while "" is an empty string; blank
+// lines are skipped.
+class CsvReader {
+public:
+    explicit CsvReader(QIODevice* device, int chunkSize = 256 * 1024);
+
+    // Reads the next record; false at end of input
+    bool readRecord(QVariantList& fields);
+    qint64 bytesRead() const;
+
+    // Appends value as one CSV field, the inverse of what readRecord()
+    // accepts: NULL is left empty, text is quoted when it needs to be
+    static void appendField(QByteArray& out, const QVariant& value);
+
+private:
+    bool fill();
+
+    QIODevice* m_device;
+    QTextStream m_stream;
+    int m_chunkSize;
+    QString m_buffer;
+    int m_pos = 0;
+};
@@ -1,31 +1,125 @@
+#pragma once
 #include <QSqlDatabase>
 #include <QVector>
+#include <QMap>
 #include "task.h"
 #include "todo.h"
 #include "template.h"
 #include <QString>
+#include <functional>
 
 namespace Database {
+    // SQLite settings applied to every connection at open time. Defaults can
+    // be overridden in the [storage] group of taskmanager.ini (next to the
+    // database) or with TASKMANAGER_* environment variables.
+    struct StorageConfig {
+        QString journalMode = "WAL";
+        QString synchronous = "NORMAL";
+        int cacheSizeKiB = 16384;
+        qint64 mmapSize = 256 * 1024 * 1024;
+        QString tempStore = "MEMORY";
+        // Completed tasks older than this move to the archive at startup;
+        // 0 turns archiving off
+        int archiveAfterDays = 30;
+    };
+
+    // Task list paging. Pages are keyed on (deadline, id) rather than an
+    // offset, so fetching page N costs the same as fetching the first one.
+    enum class TaskSort { DeadlineAscending, DeadlineDescending };
+
+    struct TaskPageKey {
+        QDateTime deadline; // invalid for a NULL deadline
+        int id = -1; // -1 starts from the first row
+    };
+
+    struct TaskFilter {
+        QString text;     // full-text match on title and description
+        int priority = -1; // -1 for any priority
+        bool includeCompleted = true;
+        QDateTime from;   // from <= deadline < to; invalid for no bound
+        QDateTime to;
+    };
+
+    // Reports work done so far out of an estimated total
+    using ProgressCallback = std::function<void(qint64 done, qint64 total)>;
+
+    // Rows moved by a bulk export or import, and how long it took
+    struct TransferStats {
+        qint64 rows = 0;
+        qint64 elapsedMs = 0;
+        double rowsPerSecond() const { return elapsedMs > 0 ? rows * 1000.0 / elapsedMs : rows; }
+    };
+
     bool initialize();
     void shutdown();
+    StorageConfig storageConfig();
+
+    // Per-thread connections. initialize() opens the default connection for
+    // the GUI thread; any other thread calls openConnection() first, after
+    // which every Database:: call made on that thread uses its connection.
+    bool openConnection(const QString& name);
+    void closeConnection(const QString& name);
+    QSqlDatabase connection();
+    // Close and reopen this thread's connection without removing it, for a
+    // restore running on another thread
+    void suspendConnection();
+    bool resumeConnection();
+    // Prepared statements are cached per connection; turning the cache off
+    // (for this thread) is only useful for benchmarking it
+    void setStatementCacheEnabled(bool enabled);
 
     // Task CRUD operations (create, read, update, delete)
     bool createTask(Task& task);
     bool updateTask(Task& task);
     bool deleteTask(int id);
     QVector<Task> getAllTasks();
+    Task getTaskById(int id); // id == -1 if not found
+    // Tasks with from <= deadline < to, ordered by deadline
+    QVector<Task> getTasksInRange(const QDateTime& from, const QDateTime& to, bool includeCompleted = true);
+    // Open tasks per day of a month: counts from a GROUP BY over the
+    // deadline index, joined with each day's first titlesPerDay titles
+    // in deadline order, all in one query
+    QMap<QDate, TaskDaySummary> getMonthSummary(int year, int month, int titlesPerDay = 3);
+    // Same for the days in [from, to), e.g. to repaint a single day
+    QMap<QDate, TaskDaySummary> getDaySummaries(const QDate& from, const QDate& to, int titlesPerDay = 3);
+    // Full-text search over title and description; every word matches as a
+    // prefix and results come best match first. limit < 0 means no limit.
+    QVector<Task> searchTasks(const QString& text, int limit = 50);
+    // Up to limit tasks matching filter that sort after afterKey
+    QVector<Task> getTasksPage(const TaskPageKey& afterKey, int limit,
+                               TaskSort sort = TaskSort::DeadlineAscending,
+                               const TaskFilter& filter = {});
+    int countTasks(const TaskFilter& filter = {});
+
+    // Archive of old completed tasks. Archived tasks keep their ids and are
+    // only read on demand; unarchiveTask() moves one back as an open task.
+    int archiveCompletedTasks(int olderThanDays); // rows moved, -1 on error
+    bool unarchiveTask(int id);
+    // Newest first; text filters on title and description
+    QVector<Task> getArchivedTasks(const QString& text = QString(), int limit = 500);
+    QVector<Task> getArchivedTasksInRange(const QDateTime& from, const QDateTime& to);
 
     // TODOList operations
     bool createTODOList(TODOList& list);
     bool updateTODOList(const TODOList& list);
     bool deleteTODOList(int id);
     QVector<TODOList> getAllTODOLists();
+    // Plans on one date, through the todo_lists(date) index
+    QVector<TODOList> getTODOListsForDate(const QDate& date);
 
     // TODOItem operations
     bool createTODOItem(TODOItem& item);
+    // Creates the list and copies the template's items into it in one
+    // transaction: all rows are written or none
+    bool createTODOListFromTemplate(TODOList& list, int templateId);
     bool updateTODOItem(const TODOItem& item);
     bool deleteTODOItem(int id);
     QVector<TODOItem> getItemsForList(int listId);
+    TODOItem getTODOItemById(int id); // id == -1 if not found
+    QVector<TODOItem> searchTODOItems(const QString& text, int limit = 50);
+    // Items of every plan on a date (or inclusive date range), in one query
+    QVector<TODOItem> getItemsForDate(const QDate& date);
+    QMap<QDate, QVector<TODOItem>> getItemsForDateRange(const QDate& from, const QDate& to);
 
     // Template operations
     bool createTemplate(Template& templ);
@@ -34,13 +128,44 @@ namespace Database {
 
     // Template item operations
     bool createTemplateItem(TemplateItem& item);
+    // Same, from a plan's items into a new template
+    bool createTemplateFromList(Template& templ, int listId);
     bool deleteTemplateItemsForTemplate(int templateId);
     QVector<TemplateItem> getItemsForTemplate(int templateId);
 
     // Restore and Backup database
     QString getDatabasePath();
-    bool backupDatabase(const QString& backupPath);
-    bool restoreDatabase(const QString& backupPath);
-    bool exportToSQL(const QString& filePath);
-    bool importFromSQL(const QString& filePath);
+    // Online, consistent backup through VACUUM INTO on this thread's
+    // connection, integrity-checked before it replaces backupPath
+    bool backupDatabase(const QString& backupPath, const ProgressCallback& progress = {});
+    // Swaps in a validated backup while running, on this thread's
+    // connection: stages a copy next to the live file, closes the
+    // connection, renames the copy over the live file, then reopens and
+    // migrates it. Every other connection must be suspended first.
+    bool restoreDatabase(const QString& backupPath, const ProgressCallback& progress = {});
+    bool exportToSQL(const QString& filePath, const ProgressCallback& progress = {});
+    // Streams the script statement by statement in one transaction;
+    // commitInterval > 0 commits every N statements to bound the WAL
+    bool importFromSQL(const QString& filePath, const ProgressCallback& progress = {},
+                       int commitInterval = 0);
+    // Binary snapshot of the data tables (format in snapshot.h), written a
+    // chunk at a time. Import checks the whole file first, then empties
+    // every data table and loads the snapshot in one transaction.
+    bool exportSnapshot(const QString& filePath, const ProgressCallback& progress = {});
+    bool importSnapshot(const QString& filePath, const ProgressCallback& progress = {});
+
+    // Streaming exchange formats for other tools, all in constant memory.
+    // JSON Lines is one file with a {"table": ..., "row": {...}} object per
+    // line; CSV is a directory with one <table>.csv (header row first) per
+    // table. Imports upsert by id (skipping tasks already on the other side
+    // of the archive) and commit every batchSize rows, so a failed import
+    // keeps the batches committed before it.
+    bool exportToJsonLines(const QString& filePath, const ProgressCallback& progress = {},
+                           TransferStats* stats = nullptr);
+    bool importFromJsonLines(const QString& filePath, const ProgressCallback& progress = {},
+                             TransferStats* stats = nullptr, int batchSize = 5000);
+    bool exportToCsv(const QString& directory, const ProgressCallback& progress = {},
+                     TransferStats* stats = nullptr);
+    bool importFromCsv(const QString& directory, const ProgressCallback& progress = {},
+                       TransferStats* stats = nullptr, int batchSize = 5000);
 }
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+#include <QObject>
+#include <QThread>
+#include <QFuture>
+#include <QFutureInterface>
+#include <QVector>
+#include <QDateTime>
+#include <functional>
+#include <memory>
+#include "database.h"
+#include "task.h"
+
+// Runs Database:: operations on a dedicated thread with its own connection,
+// so long queries, imports and exports don't block the GUI. Each call
+// returns a QFuture; watch it with a QFutureWatcher to get the result and
+// progress (0-1000, or an empty range when the job can't estimate it)
+// delivered back on the GUI thread as signals.
+class DatabaseWorker : public QObject {
+    Q_OBJECT
+public:
+    explicit DatabaseWorker(QObject* parent = nullptr);
+    ~DatabaseWorker() override;
+
+    QFuture<QVector<Task>> getAllTasks();
+    QFuture<QVector<Task>> getTasksInRange(const QDateTime& from, const QDateTime& to, bool includeCompleted = true);
+    QFuture<bool> backupDatabase(const QString& backupPath);
+    // The GUI thread suspends its connection first (see Database::restoreDatabase)
+    QFuture<bool> restoreDatabase(const QString& backupPath);
+    QFuture<bool> exportToSQL(const QString& filePath);
+    QFuture<bool> importFromSQL(const QString& filePath);
+    QFuture<bool> exportSnapshot(const QString& filePath);
+    QFuture<bool> importSnapshot(const QString& filePath);
+    // Exchange formats; stats, if given, is filled in before the future finishes
+    using StatsPtr = std::shared_ptr<Database::TransferStats>;
+    QFuture<bool> exportToJsonLines(const QString& filePath, StatsPtr stats = nullptr);
+    QFuture<bool> importFromJsonLines(const QString& filePath, StatsPtr stats = nullptr);
+    QFuture<bool> exportToCsv(const QString& directory, StatsPtr stats = nullptr);
+    QFuture<bool> importFromCsv(const QString& directory, StatsPtr stats = nullptr);
+
+private:
+    template <typename T>
+    QFuture<T> run(std::function<T(QFutureInterface<T>&)> job);
+
+    template <typename T>
+    static Database::ProgressCallback progressReporter(QFutureInterface<T>& promise);
+
+    QThread m_thread;
+    QObject* m_context; // lives on m_thread; jobs are queued to it
+};
+
+template <typename T>
+QFuture<T> DatabaseWorker::run(std::function<T(QFutureInterface<T>&)> job) {
+    auto promise = std::make_shared<QFutureInterface<T>>();
+    promise->reportStarted();
+    QFuture<T> future = promise->future();
+
+    QMetaObject::invokeMethod(m_context, [promise, job]() {
+        T result = job(*promise);
+        promise->reportResult(result);
+        promise->reportFinished();
+    });
+    return future;
+}
+
+template <typename T>
+Database::ProgressCallback DatabaseWorker::progressReporter(QFutureInterface<T>& promise) {
+    promise.setProgressRange(0, 1000);
+    return [&promise](qint64 done, qint64 total) {
+        promise.setProgressValue(total > 0 ? int(done * 1000 / total) : 0);
+    };
+}
@@ -6,11 +6,15 @@
 #include <QCalendarWidget>
 #include <QTabWidget>
 #include "todo.h"
+#include "taskstore.h"
+#include "database.h"
 #include <QListView>
 #include <QSplitter>
 #include <QLabel>
 #include <QCheckBox>
 #include <QAction>
+#include <QFuture>
+#include <functional>
 
 class QPushButton;
 class QCalendarWidget;
@@ -20,6 +24,11 @@ class QDateEdit;
 class QTextEdit;
 class QGroupEdit;
 class QGroupBox;
+class DatabaseWorker;
+class TaskTableModel;
+class TaskPageModel;
+class RefreshScheduler;
+class TaskFilterProxyModel;
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
@@ -59,22 +68,43 @@ private slots:
     void restoreDatabase();
     void exportDatabase();
     void importDatabase();
+    void exportSnapshot();
+    void importSnapshot();
+    void exportJsonLines();
+    void importJsonLines();
+    void exportCsv();
+    void importCsv();
+    void showArchive();
 
 private:
     void setupUI();
     void setupDatabase();
     void setupConnections();
+    void setupRefreshScheduler();
     void createTaskDialog(bool isEditing = false);
     void applyTableStyling();
+    // Updates every view for one changed task in place: before.id == -1
+    // for a new task, after.id == -1 for a deleted one. Driven by
+    // ChangeNotifier; refreshAllViews() stays the path for bulk changes.
+    void applyTaskChange(const Task& before, const Task& after);
+    // Full reloads for ChangeNotifier's bulk events
+    void reloadTasks();
+    void reloadAll();
+    void refreshCalendarDay(const QDate& date);
     QVector<Task> getTasksForDate(const QDate& date);
 
     // Database
-    QVector<Task> getAllFilteredTasks();
+    TaskStore taskStore;
+    DatabaseWorker* dbWorker;
+    RefreshScheduler* refreshScheduler;
+    void watchDatabaseJob(const QString& label, const QFuture<bool>& job,
+                          const std::function<void(bool)>& onFinished);
+    static QString describeTransfer(const Database::TransferStats& stats);
 
     // UI Components
     QTableView* taskView;
-    QStandardItemModel* model;
-    QSortFilterProxyModel* proxyModel;
+    TaskPageModel* model;
+    TaskFilterProxyModel* proxyModel;
 
     // Filter controls
     QLineEdit* searchBox;
@@ -98,10 +128,9 @@ private:
     // Calendar components
     QTabWidget* mainTabs;
     QCalendarWidget* calendarWidget;
-    QStandardItemModel* calendarModel;
+    TaskTableModel* calendarModel;
     QTableView* calendarTaskView;
     QTextEdit* calendarDetailsView;
-    Task getTaskByTitleAndDate(const QString& title, const QDate& date);
 
     // TODO List components
     QWidget* todoTab;
@@ -120,7 +149,7 @@ private:
     // Today Tad components
     QWidget* todayTab;
     QTableView* todayTaskView;
-    QStandardItemModel* todayTaskModel;
+    TaskTableModel* todayTaskModel;
     QTableView* todayTodoView;
     QStandardItemModel* todayTodoModel;
     QSplitter* todaySplitter;
@@ -149,6 +178,13 @@ private:
     QAction* restoreAction;
     QAction* exportAction;
     QAction* importAction;
+    QAction* exportSnapshotAction;
+    QAction* importSnapshotAction;
+    QAction* exportJsonAction;
+    QAction* importJsonAction;
+    QAction* exportCsvAction;
+    QAction* importCsvAction;
+    QAction* archiveAction;
 
     QString formatDescription(const QString& description) {
         return description.toHtmlEscaped().replace("\n", "<br>");
@@ -0,0 +1,58 @@
+#pragma once
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include <functional>
+
+class QTabWidget;
+class QWidget;
+
+// Coalesces view refreshes. Callers mark views dirty instead of reloading
+// them; all dirty views are refreshed once, on the next event-loop turn or
+// after a debounce. Views on a tab that isn't current stay dirty and are
+// refreshed when their tab is shown.
+class RefreshScheduler : public QObject {
+    Q_OBJECT
+public:
+    enum View {
+        TaskList   = 0x01,
+        Calendar   = 0x02,
+        TodayTasks = 0x04,
+        TodayPlan  = 0x08,
+        PlanLists  = 0x10,
+        PlanItems  = 0x20,
+        Templates  = 0x40
+    };
+    Q_DECLARE_FLAGS(Views, View)
+
+    explicit RefreshScheduler(QTabWidget* tabs, QObject* parent = nullptr);
+
+    // page is the tab the view lives on, or nullptr if always shown.
+    // Views are refreshed in the order they were added. An everyVisit view
+    // is refreshed each time its tab is shown, dirty or not.
+    void addView(View view, QWidget* page, const std::function<void()>& refresh,
+                 bool everyVisit = false);
+
+    // delayMs == 0 flushes on the next event-loop turn; a positive delay
+    // restarts the debounce on every call, unless a flush is already due
+    void markDirty(Views views, int delayMs = 0);
+    // Refreshes the dirty views that are visible now
+    void flush();
+
+private:
+    void tabShown();
+
+    struct Entry {
+        View view;
+        QWidget* page;
+        std::function<void()> refresh;
+        bool everyVisit;
+    };
+
+    QTabWidget* m_tabs;
+    QVector<Entry> m_views;
+    Views m_dirty;
+    QTimer m_timer;
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(RefreshScheduler::Views)
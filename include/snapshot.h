@@ -0,0 +1,101 @@
+#pragma once
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
+class QIODevice;
+
+// Binary snapshot of database tables. Little-endian throughout:
+//
+//   magic "TMSNAP\0\0" | u32 format version | u32 schema version | u32 table count
+//   per table:  str name | u64 row count | u32 column count | str column name...
+//               then chunks until the row count is reached:
+//               u32 rows in chunk | per column: u64 byte length | its values
+//   u32 CRC-32 of everything before it
+//
+// Strings are u32 length + UTF-8. Each value is a u8 type tag followed by
+// its payload: nothing for NULL, 8 bytes for integers and doubles, u32
+// length + bytes for text and blobs. Storing a column's values together
+// keeps each block homogeneous and lets the reader walk them straight out
+// of a memory-mapped file; chunking the rows lets the writer stream a
+// table in bounded memory. An empty table has no chunks.
+
+class SnapshotWriter {
+public:
+    static const quint32 kFormatVersion = 1;
+    static const int kChunkRows = 4096;
+
+    explicit SnapshotWriter(QIODevice* device);
+
+    bool begin(int schemaVersion, int tableCount);
+    bool beginTable(const QString& name, const QStringList& columns, quint64 rowCount);
+    // One encoded block per column, each holding rowCount values
+    bool writeChunk(quint32 rowCount, const QVector<QByteArray>& columnData);
+    bool finish(); // appends the checksum
+
+    // Encodes value onto the end of a column block
+    static void appendValue(QByteArray& column, const QVariant& value);
+
+private:
+    bool write(const QByteArray& data);
+    bool writeUInt32(quint32 value);
+    bool writeUInt64(quint64 value);
+    bool writeString(const QString& value);
+
+    QIODevice* m_device;
+    quint32 m_crc;
+};
+
+class SnapshotReader {
+public:
+    // One column's values within a chunk
+    struct Column {
+        const uchar* data = nullptr;
+        qint64 size = 0;
+    };
+
+    struct Chunk {
+        quint64 rowCount = 0;
+        QVector<Column> columns;
+    };
+
+    struct Table {
+        QString name;
+        quint64 rowCount = 0;
+        QStringList columns;
+        QVector<Chunk> chunks;
+    };
+
+    // Decodes one column block value by value
+    class Cursor {
+    public:
+        Cursor() = default;
+        explicit Cursor(const Column& column);
+        bool next(QVariant& value); // false at the end or on a corrupt value
+
+    private:
+        const uchar* m_pos = nullptr;
+        const uchar* m_end = nullptr;
+    };
+
+    // Maps the file and checks its structure and checksum up front, so
+    // reading the tables afterwards can't run off the end of the data
+    bool open(const QString& path);
+    QString errorString() const { return m_error; }
+
+    int schemaVersion() const { return m_schemaVersion; }
+    quint64 totalRows() const;
+    const QVector<Table>& tables() const { return m_tables; }
+
+private:
+    bool fail(const QString& error);
+
+    QFile m_file;
+    QByteArray m_fallback; // file contents when it can't be mapped
+    QVector<Table> m_tables;
+    int m_schemaVersion = 0;
+    QString m_error;
+};
@@ -0,0 +1,53 @@
+#pragma once
+#include <QString>
+#include <QTextStream>
+#include <QVariantList>
+
+class QIODevice;
+
+// Splits an SQL script into statements while reading it in chunks, so
+// arbitrarily large dumps are processed in bounded memory. Semicolons inside
+// quoted strings, quoted identifiers and comments don't end a statement, and
+// comments are stripped.
+//
+// INSERT/REPLACE statements are also returned with their literal values
+// lifted out into bind values, so rows of the same shape can share one
+// prepared statement.
+class SqlStatementReader {
+public:
+    struct Statement {
+        QString sql;           // statement as written, without comments or ';'
+        QString parameterized; // sql with literals replaced by '?'; empty if not an INSERT
+        QVariantList values;   // bind values for parameterized, in order
+    };
+
+    explicit SqlStatementReader(QIODevice* device, int chunkSize = 256 * 1024);
+
+    // Reads the next non-empty statement; false at end of input
+    bool next(Statement& statement);
+    qint64 bytesRead() const;
+
+private:
+    enum class State {
+        Normal,
+        MaybeLineComment,  // saw '-'
+        LineComment,
+        MaybeBlockComment, // saw '/'
+        BlockComment,
+        BlockCommentStar,  // saw '*' inside a block comment
+        Quoted,            // inside '...', "..." or `...`
+        QuoteEnd,          // saw the closing quote; a second one is an escape
+        Bracketed          // inside [...]
+    };
+
+    bool fill();
+    static void parameterize(Statement& statement);
+
+    QIODevice* m_device;
+    QTextStream m_stream;
+    int m_chunkSize;
+    QString m_buffer;
+    int m_pos = 0;
+    State m_state = State::Normal;
+    QChar m_quote;
+};
@@ -1,6 +1,10 @@
 #pragma once
 #include <QString>
 #include <QDateTime>
+#include <QStringList>
+
+// Priority names for display, indexed by Task::priority
+const QStringList priorityNames = {"None", "Urgent", "Important", "Urgent & Important"};
 
 struct Task {
     int id = -1;
@@ -11,6 +15,12 @@ struct Task {
     bool isCompleted = false;
 };
 
+// Open tasks due on one day, for calendar rendering
+struct TaskDaySummary {
+    int openCount = 0;
+    QStringList titles; // the first few, in deadline order
+};
+
 /* Task layout in SQLite
 
 CREATE TABLE IF NOT EXISTS tasks (
@@ -0,0 +1,37 @@
+#pragma once
+#include <QStringList>
+#include <QVector>
+#include "database.h"
+#include "task.h"
+
+// Evaluates a Database::TaskFilter in memory, matching text the way the
+// FTS index does: case- and accent-insensitive, each searched word a
+// prefix of a word in the title or description.
+class TaskFilterEngine {
+public:
+    // Folded words of a task's title and description. Compute once per
+    // task and pass to matches().
+    static QStringList searchKey(const Task& task);
+
+    // True if every task matching narrower also matches wider, so
+    // narrower can be applied to wider's rows without a query
+    static bool narrows(const Database::TaskFilter& wider, const Database::TaskFilter& narrower);
+
+    void setFilter(const Database::TaskFilter& filter);
+    const Database::TaskFilter& filter() const { return m_filter; }
+
+    bool matches(const Task& task, const QStringList& key) const;
+
+private:
+    // A typed word split into tokens; "foo-ba" must match "foo" followed
+    // by a word starting with "ba", as an FTS phrase would
+    using Term = QStringList;
+
+    static QStringList fold(const QString& text);
+    static QVector<Term> terms(const QString& text);
+    static bool implies(const Term& narrower, const Term& wider);
+
+    Database::TaskFilter m_filter;
+    QVector<Term> m_terms;
+    bool m_matchesNothing = false;
+};
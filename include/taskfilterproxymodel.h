@@ -0,0 +1,36 @@
+#pragma once
+#include <QSortFilterProxyModel>
+#include <QHash>
+#include <QStringList>
+#include "taskfilterengine.h"
+
+class TaskPageModel;
+
+// Row mask over the paged task list. A filter that only narrows the one
+// the source last loaded, with all of its rows fetched, is applied here
+// over those rows using a search key kept per task, without a query or a
+// model reset. Any other filter reloads the source.
+class TaskFilterProxyModel : public QSortFilterProxyModel {
+    Q_OBJECT
+public:
+    explicit TaskFilterProxyModel(TaskPageModel* source, QObject* parent = nullptr);
+
+    void setFilter(const Database::TaskFilter& filter);
+    // Makes the next setFilter() reload, after the data changed underneath
+    void markStale() { m_stale = true; }
+    // Tasks matching the filter, including rows not fetched yet
+    int matchCount() const;
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+
+private:
+    const QStringList& keyFor(int sourceRow) const;
+    void dropKeys(int first, int last);
+
+    TaskPageModel* m_source;
+    TaskFilterEngine m_engine;
+    bool m_masking = false;
+    bool m_stale = false;
+    mutable QHash<int, QStringList> m_keys; // search keys by task id
+};
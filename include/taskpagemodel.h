@@ -0,0 +1,37 @@
+#pragma once
+#include "tasktablemodel.h"
+#include "database.h"
+
+// Task list model that loads rows a page at a time. The view asks for more
+// through canFetchMore()/fetchMore() as it scrolls towards the end, so only
+// the rows seen so far are ever materialised.
+class TaskPageModel : public TaskTableModel {
+    Q_OBJECT
+public:
+    explicit TaskPageModel(const QVector<Column>& columns, QObject* parent = nullptr);
+
+    // Drops the loaded rows and starts again from the first page
+    void setFilter(const Database::TaskFilter& filter);
+    const Database::TaskFilter& filter() const { return m_filter; }
+    void reload();
+    // Rows matching the filter, including those not fetched yet
+    int totalCount() const { return m_totalCount; }
+    // Applies one task's change without reloading: before.id == -1 for a
+    // new task, after.id == -1 for a deleted one. Returns false if the
+    // filter has search text, which only the FTS index can evaluate;
+    // reload() in that case.
+    bool applyChange(const Task& before, const Task& after);
+
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+private:
+    static const int kPageSize = 200;
+
+    bool matches(const Task& task) const;
+
+    Database::TaskFilter m_filter;
+    Database::TaskPageKey m_lastKey;
+    int m_totalCount = 0;
+    bool m_hasMore = false;
+};
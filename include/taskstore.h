@@ -0,0 +1,38 @@
+#pragma once
+#include <QObject>
+#include <QHash>
+#include <QMultiMap>
+#include <QVector>
+#include <QDateTime>
+#include "task.h"
+
+// Write-through in-memory cache of the tasks table.
+// Loads on first read, then serves lookups from a hash index by id and an
+// ordered index by deadline. Writes go to the database; the indexes follow
+// the ChangeNotifier, so they also see writes made elsewhere (the worker
+// thread, unarchiving) and reload after a restore or import.
+class TaskStore : public QObject {
+    Q_OBJECT
+public:
+    explicit TaskStore(QObject* parent = nullptr);
+
+    bool createTask(Task& task);
+    bool updateTask(Task& task);
+    bool deleteTask(int id);
+
+    Task task(int id); // id == -1 if not found
+    QVector<Task> allTasks(); // ordered by deadline
+    // Tasks with from <= deadline < to, ordered by deadline
+    QVector<Task> tasksInRange(const QDateTime& from, const QDateTime& to, bool includeCompleted = true);
+
+private:
+    void invalidate(); // the next read reloads
+    void ensureLoaded();
+    void store(const Task& task); // replaces any cached copy
+    void index(const Task& task);
+    void unindex(int id);
+
+    bool m_loaded = false;
+    QHash<int, Task> m_byId;
+    QMultiMap<QDateTime, int> m_byDeadline;
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <QAbstractTableModel>
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
+#include <QVector>
+#include "task.h"
+
+// Read-only table model over a contiguous QVector<Task>. Each view picks
+// which columns to show; text, colours and fonts are worked out in data()
+// on demand from shared brushes and fonts rather than stored per cell.
+class TaskTableModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    enum class Column { Completed, Title, Description, Deadline, Time, Priority, Status };
+
+    explicit TaskTableModel(const QVector<Column>& columns, QObject* parent = nullptr);
+
+    // Replaces all rows. Archived tasks are listed after the live ones and
+    // show as "Archived" in the Status column.
+    void setTasks(const QVector<Task>& tasks, const QVector<Task>& archived = {});
+    void appendTasks(const QVector<Task>& tasks);
+    void clear();
+
+    // Single-row changes for when one task was edited. upsertTask() updates
+    // the task's row in place, moves it if its deadline changed, inserts it
+    // in deadline order if it is new, or removes it when it no longer
+    // belongs in this view.
+    void upsertTask(const Task& task, bool belongs = true);
+    bool removeTask(int id); // false if the task wasn't shown
+
+    const Task& taskAt(int row) const { return m_tasks.at(row); }
+    int rowOf(int id) const; // -1 if not shown
+    int columnOf(Column column) const { return m_columns.indexOf(column); }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+
+protected:
+    // Row a task with this deadline would take among the live rows
+    int insertionRow(const Task& task) const;
+    void insertTaskAt(int row, const Task& task);
+    void removeTaskAt(int row);
+
+private:
+    QString statusOf(const Task& task) const;
+    void indexRowsFrom(int row);
+    void rowsMovedFrom(int row) { m_indexedUpTo = qMin(m_indexedUpTo, row); }
+    bool isOverdue(const Task& task) const { return !task.isCompleted && task.deadline < m_now; }
+
+    QVector<Column> m_columns;
+    QVector<Task> m_tasks;
+    // Task id -> row. Inserting or removing a row doesn't renumber the ones
+    // after it; entries from m_indexedUpTo on may be stale, and rowOf()
+    // corrects them as far as it has to look.
+    mutable QHash<int, int> m_rows;
+    mutable int m_indexedUpTo = 0;
+    QSet<int> m_archived; // ids of archived rows
+    QDateTime m_now;      // overdue cut-off, taken when rows are loaded
+};
@@ -0,0 +1,23 @@
+#include "changenotifier.h"
+
+ChangeNotifier::ChangeNotifier(QObject* parent)
+    : QObject(parent) {
+    // Needed for queued delivery from the worker thread
+    qRegisterMetaType<Task>();
+    qRegisterMetaType<ChangeNotifier::TaskFields>();
+}
+
+ChangeNotifier* ChangeNotifier::instance() {
+    static ChangeNotifier notifier;
+    return &notifier;
+}
+
+ChangeNotifier::TaskFields ChangeNotifier::changedFields(const Task& before, const Task& after) {
+    TaskFields changed;
+    if (before.title != after.title) changed |= Title;
+    if (before.description != after.description) changed |= Description;
+    if (before.deadline != after.deadline) changed |= Deadline;
+    if (before.priority != after.priority) changed |= Priority;
+    if (before.isCompleted != after.isCompleted) changed |= Completed;
+    return changed;
+}
@@ -0,0 +1,96 @@
+#include "csvreader.h"
+#include <QIODevice>
+
+CsvReader::CsvReader(QIODevice* device, int chunkSize)
+    : m_device(device), m_stream(device), m_chunkSize(chunkSize) {
+    m_stream.setCodec("UTF-8");
+}
+
+qint64 CsvReader::bytesRead() const {
+    return m_device->pos();
+}
+
+bool CsvReader::fill() {
+    m_buffer = m_stream.read(m_chunkSize);
+    m_pos = 0;
+    return !m_buffer.isEmpty();
+}
+
+bool CsvReader::readRecord(QVariantList& fields) {
+    fields.clear();
+    QString field;
+    bool quoted = false;   // field started with a quote
+    bool inQuotes = false; // currently between quotes
+    bool hasContent = false;
+
+    auto endField = [&]() {
+        fields << (quoted || !field.isEmpty() ? QVariant(field) : QVariant());
+        field.clear();
+        quoted = false;
+    };
+
+    for (;;) {
+        if (m_pos == m_buffer.size() && !fill()) {
+            // End of input ends the last record, even without a newline
+            if (!hasContent) return false;
+            endField();
+            return true;
+        }
+
+        const QChar c = m_buffer.at(m_pos++);
+        if (inQuotes) {
+            if (c != '"') {
+                field += c;
+            } else if (m_pos == m_buffer.size() && !fill()) {
+                inQuotes = false;
+            } else if (m_buffer.at(m_pos) == '"') {
+                field += '"'; // doubled quote
+                ++m_pos;
+            } else {
+                inQuotes = false;
+            }
+        } else if (c == '"' && field.isEmpty() && !quoted) {
+            inQuotes = quoted = hasContent = true;
+        } else if (c == ',') {
+            endField();
+            hasContent = true;
+        } else if (c == '\n') {
+            if (!hasContent) continue; // blank line
+            endField();
+            return true;
+        } else if (c != '\r') {
+            field += c;
+            hasContent = true;
+        }
+    }
+}
+
+void CsvReader::appendField(QByteArray& out, const QVariant& value) {
+    if (value.isNull()) return;
+
+    switch (value.type()) {
+        case QVariant::Bool:
+        case QVariant::Int:
+        case QVariant::UInt:
+        case QVariant::LongLong:
+        case QVariant::ULongLong:
+            out += QByteArray::number(value.toLongLong());
+            return;
+        case QVariant::Double:
+            out += QByteArray::number(value.toDouble(), 'g', 17);
+            return;
+        default:
+            break;
+    }
+
+    const QByteArray text = value.toString().toUtf8();
+    const bool needsQuotes = text.isEmpty() || text.contains(',') || text.contains('"') ||
+                             text.contains('\n') || text.contains('\r');
+    if (!needsQuotes) {
+        out += text;
+        return;
+    }
+    out += '"';
+    out += QByteArray(text).replace('"', "\"\"");
+    out += '"';
+}
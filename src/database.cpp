@@ -1,4 +1,8 @@
 #include "database.h"
+#include "sqlstatementreader.h"
+#include "snapshot.h"
+#include "csvreader.h"
+#include "changenotifier.h"
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QDebug>
@@ -7,8 +11,765 @@
 #include <QFile>
 #include <QDir>
 #include <QFileDialog>
-#include <QTextStream>
 #include <QSqlRecord>
+#include <QHash>
+#include <QSet>
+#include <QSettings>
+#include <QFileInfo>
+#include <QRegExp>
+#include <QSqlDriver>
+#include <QSaveFile>
+#include <QUrl>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace {
+    // Connection used by Database:: calls on this thread; empty means the
+    // default (GUI thread) connection
+    thread_local QString currentConnection;
+
+    // Prepared statements, per connection and keyed by SQL text. Copies of a
+    // QSqlQuery share the underlying statement, so handing out copies lets
+    // SQLite skip re-parsing on every call. Connections are thread-affine,
+    // so the caches are too.
+    QHash<QString, QHash<QString, QSqlQuery>>& statementCaches() {
+        thread_local QHash<QString, QHash<QString, QSqlQuery>> caches;
+        return caches;
+    }
+
+    // Only turned off by db_bench, to measure what the cache saves
+    thread_local bool statementCacheEnabled = true;
+
+    QSqlQuery preparedQuery(const QString& sql) {
+        QSqlDatabase db = Database::connection();
+        if (!statementCacheEnabled) {
+            QSqlQuery query(db);
+            query.setForwardOnly(true);
+            if (!query.prepare(sql)) {
+                qWarning() << "prepare failed:" << query.lastError().text();
+            }
+            return query;
+        }
+        QHash<QString, QSqlQuery>& cache = statementCaches()[db.connectionName()];
+
+        auto it = cache.constFind(sql);
+        if (it != cache.constEnd()) {
+            QSqlQuery query = it.value();
+            query.finish();
+            return query;
+        }
+
+        QSqlQuery query(db);
+        query.setForwardOnly(true); // must precede prepare()
+        if (!query.prepare(sql)) {
+            // Not cached; the caller's exec() reports the error
+            qWarning() << "prepare failed:" << query.lastError().text();
+            return query;
+        }
+        cache.insert(sql, query);
+        return query;
+    }
+
+    // Returns value if it is one of allowed (case-insensitive), else fallback
+    QString pickSetting(const QString& value, const QStringList& allowed, const QString& fallback) {
+        QString upper = value.trimmed().toUpper();
+        if (upper.isEmpty()) return fallback;
+        if (allowed.contains(upper)) return upper;
+        qWarning() << "Ignoring invalid storage setting" << value << "- expected one of" << allowed;
+        return fallback;
+    }
+
+    bool applyStorageConfig(const QSqlDatabase& db, const Database::StorageConfig& config) {
+        const QStringList pragmas = {
+            QString("PRAGMA journal_mode = %1").arg(config.journalMode),
+            QString("PRAGMA synchronous = %1").arg(config.synchronous),
+            QString("PRAGMA cache_size = %1").arg(-config.cacheSizeKiB), // negative = KiB
+            QString("PRAGMA mmap_size = %1").arg(config.mmapSize),
+            QString("PRAGMA temp_store = %1").arg(config.tempStore)
+        };
+
+        QSqlQuery query(db);
+        for (const QString& pragma : pragmas) {
+            if (!query.exec(pragma)) {
+                qWarning() << pragma << "failed:" << query.lastError().text();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool openDatabase(QSqlDatabase& db) {
+        db.setDatabaseName(Database::getDatabasePath());
+        if (!db.open()) {
+            qCritical() << "Database error: " << db.lastError();
+            return false;
+        }
+
+        if (!applyStorageConfig(db, Database::storageConfig())) {
+            qWarning() << "Continuing with default SQLite storage settings";
+        }
+        return true;
+    }
+
+    // QSQLITE stores a bound QDateTime as ISO text with milliseconds, so
+    // range bounds use exactly that form and compare lexicographically with
+    // the stored values (which lets SQLite use the index). A plain
+    // Qt::ISODate bound ("...:00") sorts before the same stored time
+    // ("...:00.000") and breaks equality at the boundary.
+    QString deadlineKey(const QDateTime& dateTime) {
+        return dateTime.toString(Qt::ISODateWithMs);
+    }
+
+    // Explicit column lists for the read path. The decoders below read by
+    // ordinal, so they must match these lists column for column.
+    const char* const kTaskColumns = "id, title, description, deadline, priority, is_completed";
+    const char* const kTODOItemColumns = "id, list_id, title, description, priority, duration, completed";
+    const char* const kTemplateItemColumns = "id, template_id, title, description, priority, duration";
+
+    Task taskFromQuery(const QSqlQuery& query) {
+        Task task;
+        task.id = query.value(0).toInt();
+        task.title = query.value(1).toString();
+        task.description = query.value(2).toString();
+        task.deadline = query.value(3).toDateTime();
+        task.priority = query.value(4).toInt();
+        task.isCompleted = query.value(5).toBool();
+        return task;
+    }
+
+    TODOItem todoItemFromQuery(const QSqlQuery& query) {
+        TODOItem item;
+        item.id = query.value(0).toInt();
+        item.listId = query.value(1).toInt();
+        item.title = query.value(2).toString();
+        item.description = query.value(3).toString();
+        item.priority = query.value(4).toInt();
+        item.duration = query.value(5).toInt();
+        item.completed = query.value(6).toBool();
+        return item;
+    }
+
+    TemplateItem templateItemFromQuery(const QSqlQuery& query) {
+        TemplateItem item;
+        item.id = query.value(0).toInt();
+        item.templateId = query.value(1).toInt();
+        item.title = query.value(2).toString();
+        item.description = query.value(3).toString();
+        item.priority = query.value(4).toInt();
+        item.duration = query.value(5).toInt();
+        return item;
+    }
+
+    // Turns free text typed by the user into an FTS5 query: every word must
+    // match as a prefix. Words are quoted so FTS5 operators in the input are
+    // taken literally. Returns an empty string if nothing is searchable.
+    QString ftsQuery(const QString& text) {
+        QStringList terms;
+        const QStringList words = text.split(QRegExp("\\s+"), Qt::SkipEmptyParts);
+        for (QString word : words) {
+            word.remove('"');
+            bool searchable = false;
+            for (const QChar& c : word) {
+                if (c.isLetterOrNumber()) {
+                    searchable = true;
+                    break;
+                }
+            }
+            if (searchable) terms << "\"" + word + "\"*";
+        }
+        return terms.join(' ');
+    }
+
+    // Conditions for a TaskFilter, each starting with AND; bindTaskFilter()
+    // binds their values in order. Returns false when the filter can't match
+    // anything (search text with no searchable words).
+    bool taskFilterClause(const Database::TaskFilter& filter, QString& clause, QString& match) {
+        match = ftsQuery(filter.text);
+        if (match.isEmpty() && !filter.text.trimmed().isEmpty()) return false;
+
+        clause.clear();
+        if (!match.isEmpty()) clause += "AND id IN (SELECT rowid FROM tasks_fts WHERE tasks_fts MATCH ?) ";
+        if (filter.priority >= 0) clause += "AND priority = ? ";
+        if (!filter.includeCompleted) clause += "AND is_completed = 0 ";
+        if (filter.from.isValid()) clause += "AND deadline >= ? ";
+        if (filter.to.isValid()) clause += "AND deadline < ? ";
+        return true;
+    }
+
+    void bindTaskFilter(QSqlQuery& query, const Database::TaskFilter& filter, const QString& match) {
+        if (!match.isEmpty()) query.addBindValue(match);
+        if (filter.priority >= 0) query.addBindValue(filter.priority);
+        if (filter.from.isValid()) query.addBindValue(deadlineKey(filter.from));
+        if (filter.to.isValid()) query.addBindValue(deadlineKey(filter.to));
+    }
+
+    // Tables holding user data, in dependency order (parents first)
+    const QStringList& dataTables() {
+        static const QStringList tables = {
+            "tasks", "tasks_archive", "todo_lists", "todo_items", "templates", "template_items"
+        };
+        return tables;
+    }
+
+    QStringList tableColumns(const QSqlDatabase& db, const QString& table) {
+        QStringList columns;
+        QSqlQuery query(db);
+        if (query.exec(QString("PRAGMA table_info(%1)").arg(table))) {
+            while (query.next()) {
+                columns << query.value(1).toString();
+            }
+        }
+        return columns;
+    }
+
+    // Drops the triggers that keep the FTS indexes in sync and fills restore
+    // with the statements that recreate them and rebuild each index. FTS5
+    // flushes its pending terms after every statement, so a bulk load is
+    // far cheaper without them and with one rebuild at the end.
+    bool dropFtsTriggers(QSqlDatabase& db, QStringList& restore, QString& error) {
+        QSqlQuery query(db);
+        if (!query.exec("SELECT name, sql FROM sqlite_master "
+                        "WHERE type = 'trigger' AND name GLOB '*_fts_*'")) {
+            error = query.lastError().text();
+            return false;
+        }
+        QStringList triggers, rebuilds;
+        while (query.next()) {
+            const QString name = query.value(0).toString();
+            const QString index = name.left(name.lastIndexOf('_'));
+            triggers << name;
+            restore << query.value(1).toString();
+            const QString rebuild = QString("INSERT INTO %1(%1) VALUES ('rebuild')").arg(index);
+            if (!rebuilds.contains(rebuild)) rebuilds << rebuild;
+        }
+        restore << rebuilds;
+
+        for (const QString& trigger : triggers) {
+            if (!query.exec("DROP TRIGGER " + trigger)) {
+                error = query.lastError().text();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Appends value as an SQL literal. Text is UTF-8 with quotes doubled,
+    // blobs are hex literals and numbers keep full precision.
+    void appendSqlLiteral(QByteArray& out, const QVariant& value) {
+        if (value.isNull()) {
+            out += "NULL";
+            return;
+        }
+
+        switch (value.type()) {
+            case QVariant::Bool:
+            case QVariant::Int:
+            case QVariant::UInt:
+            case QVariant::LongLong:
+            case QVariant::ULongLong:
+                out += QByteArray::number(value.toLongLong());
+                break;
+            case QVariant::Double:
+                out += QByteArray::number(value.toDouble(), 'g', 17);
+                break;
+            case QVariant::ByteArray:
+                out += "X'";
+                out += value.toByteArray().toHex();
+                out += '\'';
+                break;
+            case QVariant::DateTime:
+                out += '\'';
+                out += value.toDateTime().toString(Qt::ISODateWithMs).toUtf8();
+                out += '\'';
+                break;
+            default:
+                out += '\'';
+                out += value.toString().toUtf8().replace('\'', "''");
+                out += '\'';
+                break;
+        }
+    }
+
+    // Runs check on a private connection to the database file at path,
+    // torn down before returning, so files other than the live database
+    // never share a connection or statement cache with it
+    bool withDatabaseFile(const QString& path, const QString& options,
+                          const std::function<bool(QSqlDatabase&)>& check) {
+        static QAtomicInt serial;
+        const QString name = QStringLiteral("file-%1").arg(serial.fetchAndAddRelaxed(1));
+        bool ok = false;
+        {
+            QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+            db.setConnectOptions(options);
+            db.setDatabaseName(path);
+            if (db.open()) {
+                ok = check(db);
+            } else {
+                qWarning() << "Could not open" << path << ":" << db.lastError().text();
+            }
+            db.close();
+        }
+        QSqlDatabase::removeDatabase(name);
+        return ok;
+    }
+
+    bool passesIntegrityCheck(QSqlDatabase& db) {
+        QSqlQuery query(db);
+        return query.exec("PRAGMA integrity_check") && query.next() &&
+               query.value(0).toString() == "ok";
+    }
+
+    // Used to size result vectors up front; a full-table COUNT(*) walks the
+    // smallest index, which is far cheaper than growing the vector repeatedly
+    int countRows(const QString& table) {
+        QSqlQuery query = preparedQuery(QString("SELECT COUNT(*) FROM %1").arg(table));
+        int count = (query.exec() && query.next()) ? query.value(0).toInt() : 0;
+        query.finish();
+        return count;
+    }
+
+    // JSON numbers are doubles; whole ones go back in as integers
+    QVariant jsonToVariant(const QJsonValue& value) {
+        switch (value.type()) {
+            case QJsonValue::Null:
+            case QJsonValue::Undefined:
+                return QVariant();
+            case QJsonValue::Bool:
+                return value.toBool() ? 1 : 0;
+            case QJsonValue::Double: {
+                const double number = value.toDouble();
+                if (number == std::floor(number) && std::fabs(number) < 9007199254740992.0) {
+                    return qint64(number);
+                }
+                return number;
+            }
+            case QJsonValue::String:
+                return value.toString();
+            default: // nested arrays and objects are kept as JSON text
+                return QString::fromUtf8(value.isArray()
+                    ? QJsonDocument(value.toArray()).toJson(QJsonDocument::Compact)
+                    : QJsonDocument(value.toObject()).toJson(QJsonDocument::Compact));
+        }
+    }
+
+    void reportTransfer(const char* operation, qint64 rows, const QElapsedTimer& timer,
+                        Database::TransferStats* stats) {
+        Database::TransferStats result;
+        result.rows = rows;
+        result.elapsedMs = timer.elapsed();
+        qDebug() << operation << "moved" << rows << "rows in" << result.elapsedMs << "ms,"
+                 << qRound64(result.rowsPerSecond()) << "rows/s";
+        if (stats) *stats = result;
+    }
+
+    // Upserts rows for the exchange imports. Table and column names come
+    // from the input file, so only those in the current schema are used;
+    // rows for unknown tables are skipped. Each table and column set gets
+    // one prepared statement, and a transaction is committed every
+    // batchSize rows. Destroying it rolls back the open batch.
+    //
+    // Existing ids are updated in place rather than with INSERT OR REPLACE:
+    // REPLACE deletes without firing delete triggers (recursive_triggers is
+    // off), which would leave stale entries in the FTS indexes. A task id
+    // already in the other one of tasks/tasks_archive is skipped, so a task
+    // never ends up in both.
+    class BatchInserter {
+    public:
+        BatchInserter(QSqlDatabase db, int batchSize)
+            : m_db(db), m_batchSize(qMax(1, batchSize)) {}
+
+        ~BatchInserter() {
+            if (m_inTransaction) {
+                m_statements.clear();
+                m_db.rollback();
+            }
+            // Batches committed before a failure stay in the database
+            if (m_committed) emit ChangeNotifier::instance()->dataReset();
+        }
+
+        bool insert(const QString& table, const QStringList& columns, const QVariantList& values) {
+            auto known = m_columns.find(table);
+            if (known == m_columns.end()) {
+                const QStringList schema = dataTables().contains(table) ? tableColumns(m_db, table) : QStringList();
+                if (schema.isEmpty()) qWarning() << "Import: skipping rows for unknown table" << table;
+                known = m_columns.insert(table, schema);
+            }
+            if (known->isEmpty()) return true;
+
+            QStringList usable;
+            QVariantList bound;
+            for (int i = 0; i < columns.size(); ++i) {
+                if (known->contains(columns.at(i))) {
+                    usable << columns.at(i);
+                    bound << values.value(i);
+                }
+            }
+            if (usable.isEmpty()) {
+                m_error = QString("no known columns for %1").arg(table);
+                return false;
+            }
+
+            const int idColumn = usable.indexOf("id");
+            const QString twin = table == "tasks" ? "tasks_archive"
+                               : table == "tasks_archive" ? "tasks" : QString();
+            const bool guarded = idColumn != -1 && !twin.isEmpty();
+            if (guarded) bound << bound.at(idColumn);
+
+            const QString key = table + ':' + usable.join(',');
+            auto statement = m_statements.find(key);
+            if (statement == m_statements.end()) {
+                QStringList placeholders, updates;
+                for (const QString& column : usable) {
+                    placeholders << "?";
+                    if (column != "id") updates << QString("%1 = excluded.%1").arg(column);
+                }
+                // "WHERE 1" keeps the upsert clause unambiguous after a SELECT
+                QString sql = QString("INSERT INTO %1 (%2) SELECT %3 WHERE 1 ")
+                              .arg(table, usable.join(", "), placeholders.join(", "));
+                if (guarded) sql += QString("AND NOT EXISTS (SELECT 1 FROM %1 WHERE id = ?) ").arg(twin);
+                if (idColumn != -1) {
+                    sql += updates.isEmpty() ? QString("ON CONFLICT(id) DO NOTHING")
+                                             : "ON CONFLICT(id) DO UPDATE SET " + updates.join(", ");
+                }
+
+                QSqlQuery query(m_db);
+                if (!query.prepare(sql)) {
+                    m_error = query.lastError().text();
+                    return false;
+                }
+                statement = m_statements.insert(key, query);
+            }
+
+            if (!m_inTransaction) {
+                if (!m_db.transaction()) {
+                    m_error = m_db.lastError().text();
+                    return false;
+                }
+                m_inTransaction = true;
+            }
+
+            for (int i = 0; i < bound.size(); ++i) {
+                statement->bindValue(i, bound.at(i));
+            }
+            if (!statement->exec()) {
+                m_error = statement->lastError().text();
+                return false;
+            }
+            ++m_rows;
+            return ++m_sinceCommit < m_batchSize || commit();
+        }
+
+        bool commit() {
+            if (!m_inTransaction) return true;
+            m_inTransaction = false;
+            m_sinceCommit = 0;
+            if (!m_db.commit()) {
+                m_error = m_db.lastError().text();
+                m_db.rollback();
+                return false;
+            }
+            m_committed = true;
+            return true;
+        }
+
+        qint64 rows() const { return m_rows; }
+        QString errorString() const { return m_error; }
+
+    private:
+        QSqlDatabase m_db;
+        int m_batchSize;
+        QHash<QString, QStringList> m_columns;
+        QHash<QString, QSqlQuery> m_statements;
+        bool m_inTransaction = false;
+        bool m_committed = false;
+        int m_sinceCommit = 0;
+        qint64 m_rows = 0;
+        QString m_error;
+    };
+
+    struct Migration {
+        int version;
+        QStringList statements;
+    };
+
+    // Schema history, applied in order and recorded in PRAGMA user_version.
+    // Append new migrations at the end; never edit one that has shipped.
+    const QVector<Migration>& migrations() {
+        static const QVector<Migration> list = {
+            // Version 1: the original tables (IF NOT EXISTS, so databases
+            // created before versioning adopt it cleanly) plus secondary
+            // indexes for the date, list and template lookups.
+            { 1, {
+                "CREATE TABLE IF NOT EXISTS tasks ("
+                "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                "title TEXT NOT NULL,"
+                "description TEXT,"
+                "deadline DATETIME,"
+                "priority INTEGER DEFAULT 0,"
+                "is_completed BOOLEAN DEFAULT 0)",
+
+                "CREATE TABLE IF NOT EXISTS todo_lists ("
+                "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                "name TEXT NOT NULL,"
+                "date DATE NOT NULL)",
+
+                "CREATE TABLE IF NOT EXISTS todo_items ("
+                "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                "list_id INTEGER NOT NULL,"
+                "title TEXT NOT NULL,"
+                "description TEXT,"
+                "priority INTEGER DEFAULT 0,"
+                "duration INTEGER DEFAULT 30,"
+                "completed BOOLEAN DEFAULT 0,"
+                "FOREIGN KEY(list_id) REFERENCES todo_lists(id))",
+
+                "CREATE TABLE IF NOT EXISTS templates ("
+                "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                "name TEXT NOT NULL)",
+
+                "CREATE TABLE IF NOT EXISTS template_items ("
+                "id INTEGER PRIMARY KEY AUTOINCREMENT,"
+                "template_id INTEGER NOT NULL,"
+                "title TEXT NOT NULL,"
+                "description TEXT,"
+                "priority INTEGER DEFAULT 0,"
+                "duration INTEGER DEFAULT 30,"
+                "FOREIGN KEY(template_id) REFERENCES templates(id))",
+
+                "CREATE INDEX IF NOT EXISTS idx_tasks_deadline_completed ON tasks(deadline, is_completed)",
+                "CREATE INDEX IF NOT EXISTS idx_todo_lists_date ON todo_lists(date)",
+                "CREATE INDEX IF NOT EXISTS idx_todo_items_list ON todo_items(list_id)",
+                "CREATE INDEX IF NOT EXISTS idx_template_items_template ON template_items(template_id)"
+            }},
+
+            // Version 2: FTS5 indexes over task and plan item text, kept in
+            // sync with their tables by triggers
+            { 2, {
+                "CREATE VIRTUAL TABLE IF NOT EXISTS tasks_fts USING fts5("
+                "title, description, content='tasks', content_rowid='id')",
+
+                "CREATE TRIGGER IF NOT EXISTS tasks_fts_insert AFTER INSERT ON tasks BEGIN "
+                "INSERT INTO tasks_fts(rowid, title, description) "
+                "VALUES (new.id, new.title, new.description); "
+                "END",
+
+                "CREATE TRIGGER IF NOT EXISTS tasks_fts_delete AFTER DELETE ON tasks BEGIN "
+                "INSERT INTO tasks_fts(tasks_fts, rowid, title, description) "
+                "VALUES ('delete', old.id, old.title, old.description); "
+                "END",
+
+                "CREATE TRIGGER IF NOT EXISTS tasks_fts_update AFTER UPDATE OF title, description ON tasks BEGIN "
+                "INSERT INTO tasks_fts(tasks_fts, rowid, title, description) "
+                "VALUES ('delete', old.id, old.title, old.description); "
+                "INSERT INTO tasks_fts(rowid, title, description) "
+                "VALUES (new.id, new.title, new.description); "
+                "END",
+
+                "INSERT INTO tasks_fts(tasks_fts) VALUES ('rebuild')",
+
+                "CREATE VIRTUAL TABLE IF NOT EXISTS todo_items_fts USING fts5("
+                "title, description, content='todo_items', content_rowid='id')",
+
+                "CREATE TRIGGER IF NOT EXISTS todo_items_fts_insert AFTER INSERT ON todo_items BEGIN "
+                "INSERT INTO todo_items_fts(rowid, title, description) "
+                "VALUES (new.id, new.title, new.description); "
+                "END",
+
+                "CREATE TRIGGER IF NOT EXISTS todo_items_fts_delete AFTER DELETE ON todo_items BEGIN "
+                "INSERT INTO todo_items_fts(todo_items_fts, rowid, title, description) "
+                "VALUES ('delete', old.id, old.title, old.description); "
+                "END",
+
+                "CREATE TRIGGER IF NOT EXISTS todo_items_fts_update AFTER UPDATE OF title, description ON todo_items BEGIN "
+                "INSERT INTO todo_items_fts(todo_items_fts, rowid, title, description) "
+                "VALUES ('delete', old.id, old.title, old.description); "
+                "INSERT INTO todo_items_fts(rowid, title, description) "
+                "VALUES (new.id, new.title, new.description); "
+                "END",
+
+                "INSERT INTO todo_items_fts(todo_items_fts) VALUES ('rebuild')"
+            }},
+
+            // Version 3: completion time on tasks, and an archive table that
+            // old completed tasks move to so the hot table stays small
+            { 3, {
+                "ALTER TABLE tasks ADD COLUMN completed_at DATETIME",
+
+                // When existing tasks were completed is unknown; start their clock now
+                "UPDATE tasks SET completed_at = strftime('%Y-%m-%dT%H:%M:%S', 'now', 'localtime') "
+                "WHERE is_completed = 1",
+
+                "CREATE TABLE IF NOT EXISTS tasks_archive ("
+                "id INTEGER PRIMARY KEY,"
+                "title TEXT NOT NULL,"
+                "description TEXT,"
+                "deadline DATETIME,"
+                "priority INTEGER DEFAULT 0,"
+                "is_completed BOOLEAN DEFAULT 1,"
+                "completed_at DATETIME,"
+                "archived_at DATETIME)",
+
+                "CREATE INDEX IF NOT EXISTS idx_tasks_archive_deadline ON tasks_archive(deadline)"
+            }},
+        };
+        return list;
+    }
+
+    int schemaVersion(const QSqlDatabase& db) {
+        QSqlQuery query(db);
+        if (!query.exec("PRAGMA user_version") || !query.next()) {
+            qWarning() << "Could not read schema version:" << query.lastError().text();
+            return -1;
+        }
+        return query.value(0).toInt();
+    }
+
+    // Brings the schema up to the latest version. Each migration runs in its
+    // own transaction, so a failure leaves the database at the last good version.
+    bool migrate(QSqlDatabase db) {
+        int current = schemaVersion(db);
+        if (current < 0) return false;
+
+        for (const Migration& migration : migrations()) {
+            if (migration.version <= current) continue;
+
+            if (!db.transaction()) {
+                qCritical() << "Migration" << migration.version << "could not start:" << db.lastError().text();
+                return false;
+            }
+
+            QSqlQuery query(db);
+            for (const QString& statement : migration.statements) {
+                if (!query.exec(statement)) {
+                    qCritical() << "Migration" << migration.version << "failed:" << query.lastError().text();
+                    db.rollback();
+                    return false;
+                }
+            }
+
+            if (!query.exec(QString("PRAGMA user_version = %1").arg(migration.version)) || !db.commit()) {
+                qCritical() << "Migration" << migration.version << "failed to commit:" << db.lastError().text();
+                db.rollback();
+                return false;
+            }
+            qDebug() << "Database schema migrated to version" << migration.version;
+        }
+        return true;
+    }
+
+    // Row inserts behind the create functions, without the change
+    // notification: the template/plan copies run these in one transaction
+    // and announce the result once it has committed
+    bool insertTODOList(TODOList& list) {
+        QSqlQuery query = preparedQuery(
+            "INSERT INTO todo_lists (name, date) VALUES (?, ?)"
+        );
+        query.addBindValue(list.name);
+        query.addBindValue(list.date);
+
+        if (!query.exec()) {
+            qWarning() << "createTODOList failed:" << query.lastError().text();
+            return false;
+        }
+
+        list.id = query.lastInsertId().toInt();
+        return true;
+    }
+
+    bool insertTODOItem(TODOItem& item) {
+        QSqlQuery query = preparedQuery(
+            "INSERT INTO todo_items ("
+            "list_id, title, description, priority, duration, completed"
+            ") VALUES (?, ?, ?, ?, ?, ?)"
+        );
+        query.addBindValue(item.listId);
+        query.addBindValue(item.title);       // NEW
+        query.addBindValue(item.description); // NEW
+        query.addBindValue(item.priority);    // NEW
+        query.addBindValue(item.duration);
+        query.addBindValue(item.completed);
+
+        if (!query.exec()) {
+            qWarning() << "createTODOItem failed:" << query.lastError().text();
+            return false;
+        }
+
+        item.id = query.lastInsertId().toInt();
+        return true;
+    }
+
+    bool insertTemplate(Template& templ) {
+        QSqlQuery query = preparedQuery("INSERT INTO templates (name) VALUES (?)");
+        query.addBindValue(templ.name);
+    
+        if (!query.exec()) {
+            qWarning() << "createTemplate failed:" << query.lastError().text();
+            return false;
+        }
+    
+        templ.id = query.lastInsertId().toInt();
+        return true;
+    }
+
+    bool insertTemplateItem(TemplateItem& item) {
+        QSqlQuery query = preparedQuery(
+            "INSERT INTO template_items ("
+            "template_id, title, description, priority, duration"
+            ") VALUES (?, ?, ?, ?, ?)"
+        );
+        query.addBindValue(item.templateId);
+        query.addBindValue(item.title);
+        query.addBindValue(item.description);
+        query.addBindValue(item.priority);
+        query.addBindValue(item.duration);
+
+        if (!query.exec()) {
+            qWarning() << "createTemplateItem failed:" << query.lastError().text();
+            return false;
+        }
+
+        item.id = query.lastInsertId().toInt();
+        return true;
+    }
+
+    // A restore candidate must be an intact TaskManager database no newer
+    // than this build understands. Opened immutable so checking it never
+    // writes next to the backup, even for WAL-mode files.
+    bool isValidBackup(const QString& path) {
+        if (!QFileInfo(path).isFile()) {
+            qWarning() << "Backup not found:" << path;
+            return false;
+        }
+
+        const QString uri = QUrl::fromLocalFile(path).toString(QUrl::FullyEncoded) + "?immutable=1";
+        return withDatabaseFile(uri, "QSQLITE_OPEN_READONLY;QSQLITE_OPEN_URI", [&](QSqlDatabase& db) {
+            if (!passesIntegrityCheck(db)) {
+                qWarning() << "Backup failed the integrity check:" << path;
+                return false;
+            }
+
+            QSqlQuery query(db);
+            if (!query.exec("SELECT (SELECT user_version FROM pragma_user_version), "
+                            "EXISTS (SELECT 1 FROM sqlite_master WHERE type = 'table' AND name = 'tasks')") ||
+                !query.next()) {
+                qWarning() << "Backup schema could not be read:" << query.lastError().text();
+                return false;
+            }
+            if (query.value(0).toInt() > migrations().last().version || !query.value(1).toBool()) {
+                qWarning() << "Backup is not a compatible TaskManager database:" << path;
+                return false;
+            }
+            return true;
+        });
+    }
+}
 
 bool Database::initialize() {
     QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
@@ -27,74 +788,107 @@ bool Database::initialize() {
         return false;
     }
     
-    // Set database path
-    QString dbPath = dataDir + "/taskmanager.db";
-    qDebug() << "Using database at:" << dbPath;
-    db.setDatabaseName(dbPath);
-    
-    if (!db.open()) {
-        qCritical() << "Database error: " << db.lastError();
-        return false;
-    }
-
-    // Create tables if missing
-    QSqlQuery query;
-    return query.exec(
-        "CREATE TABLE IF NOT EXISTS tasks ("
-        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-        "title TEXT NOT NULL,"
-        "description TEXT,"
-        "deadline DATETIME,"
-        "priority INTEGER DEFAULT 0,"
-        "is_completed BOOLEAN DEFAULT 0)"
-    ) && query.exec(
-        "CREATE TABLE IF NOT EXISTS todo_lists ("
-        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-        "name TEXT NOT NULL,"
-        "date DATE NOT NULL)"
-    ) && query.exec(
-        "CREATE TABLE IF NOT EXISTS todo_items ("
-        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-        "list_id INTEGER NOT NULL,"
-        "title TEXT NOT NULL,"
-        "description TEXT," 
-        "priority INTEGER DEFAULT 0,"
-        "duration INTEGER DEFAULT 30,"
-        "completed BOOLEAN DEFAULT 0,"
-        "FOREIGN KEY(list_id) REFERENCES todo_lists(id))"
-    ) && query.exec(
-        "CREATE TABLE IF NOT EXISTS templates ("
-        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-        "name TEXT NOT NULL)"
-    ) && query.exec(
-        "CREATE TABLE IF NOT EXISTS template_items ("
-        "id INTEGER PRIMARY KEY AUTOINCREMENT,"
-        "template_id INTEGER NOT NULL,"
-        "title TEXT NOT NULL,"
-        "description TEXT,"
-        "priority INTEGER DEFAULT 0,"
-        "duration INTEGER DEFAULT 30,"
-        "FOREIGN KEY(template_id) REFERENCES templates(id))"
-    );
+    qDebug() << "Using database at:" << getDatabasePath();
+    const bool firstRun = !QFileInfo::exists(getDatabasePath());
+    if (!openDatabase(db)) {
+        return false;
+    }
+
+    if (!migrate(db)) {
+        return false;
+    }
+
+    // Cold start: a new database is loaded from a snapshot left in the
+    // data directory, e.g. one exported on another machine
+    const QString seed = dir.filePath("taskmanager.tmsnap");
+    if (firstRun && QFileInfo(seed).isFile()) {
+        QElapsedTimer timer;
+        timer.start();
+        if (importSnapshot(seed)) {
+            qDebug() << "Loaded" << seed << "in" << timer.elapsed() << "ms";
+        }
+    }
+
+    // Archive policy runs once per start
+    const int archiveAfterDays = storageConfig().archiveAfterDays;
+    if (archiveAfterDays > 0) {
+        int archived = archiveCompletedTasks(archiveAfterDays);
+        if (archived > 0) {
+            qDebug() << "Archived" << archived << "completed tasks";
+        }
+    }
+    return true;
 }
 
 void Database::shutdown() {
-    QSqlDatabase::database().close();
+    QSqlDatabase db = QSqlDatabase::database();
+    statementCaches().remove(db.connectionName());
+    db.close();
+}
+
+bool Database::openConnection(const QString& name) {
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", name);
+        if (!openDatabase(db)) {
+            db = QSqlDatabase();
+            QSqlDatabase::removeDatabase(name);
+            return false;
+        }
+    }
+    currentConnection = name;
+    return true;
+}
+
+void Database::closeConnection(const QString& name) {
+    statementCaches().remove(name);
+    {
+        QSqlDatabase db = QSqlDatabase::database(name, false);
+        db.close();
+    }
+    QSqlDatabase::removeDatabase(name);
+    if (currentConnection == name) {
+        currentConnection.clear();
+    }
+}
+
+void Database::setStatementCacheEnabled(bool enabled) {
+    statementCacheEnabled = enabled;
+    if (!enabled) {
+        statementCaches().remove(connection().connectionName());
+    }
+}
+
+QSqlDatabase Database::connection() {
+    return currentConnection.isEmpty() ? QSqlDatabase::database()
+                                       : QSqlDatabase::database(currentConnection, false);
+}
+
+void Database::suspendConnection() {
+    // Cached statements would otherwise keep the old file busy
+    QSqlDatabase db = connection();
+    statementCaches().remove(db.connectionName());
+    db.close();
+}
+
+bool Database::resumeConnection() {
+    QSqlDatabase db = connection();
+    return db.isOpen() || openDatabase(db);
 }
 
 // Task Operations
 bool Database::createTask(Task& task) {
-    QSqlQuery query;
-    query.prepare(
+    QSqlQuery query = preparedQuery(
         "INSERT INTO tasks ("
-        "title, description, deadline, priority, is_completed"
-        ") VALUES (?, ?, ?, ?, ?)"
+        "title, description, deadline, priority, is_completed, completed_at"
+        ") VALUES (?, ?, ?, ?, ?, ?)"
     );
     query.addBindValue(task.title);
     query.addBindValue(task.description);
     query.addBindValue(task.deadline);
     query.addBindValue(task.priority);
     query.addBindValue(task.isCompleted);
+    query.addBindValue(task.isCompleted ? QVariant(deadlineKey(QDateTime::currentDateTime()))
+                                        : QVariant(QVariant::String));
 
     if (!query.exec()) {
         qWarning() << "createTask failed:" << query.lastError().text();
@@ -102,18 +896,21 @@ bool Database::createTask(Task& task) {
     }
 
     task.id = query.lastInsertId().toInt();
+    emit ChangeNotifier::instance()->taskInserted(task);
     return true;
 }
 
 bool Database::updateTask(Task& task) {
-    QSqlQuery query;
-    query.prepare(
+    const Task before = getTaskById(task.id);
+    QSqlQuery query = preparedQuery(
         "UPDATE tasks SET "
         "title = ?, "
         "description = ?, "
         "deadline = ?, "
         "priority = ?, "
-        "is_completed = ? "
+        "is_completed = ?, "
+        // Keeps the first completion time; reopening clears it
+        "completed_at = CASE WHEN ? THEN coalesce(completed_at, ?) END "
         "WHERE id = ?"
     );
     query.addBindValue(task.title);
@@ -121,30 +918,37 @@ bool Database::updateTask(Task& task) {
     query.addBindValue(task.deadline);
     query.addBindValue(task.priority);
     query.addBindValue(task.isCompleted);
+    query.addBindValue(task.isCompleted);
+    query.addBindValue(deadlineKey(QDateTime::currentDateTime()));
     query.addBindValue(task.id);
 
     if (!query.exec()) {
         qWarning() << "updateTask failed:" << query.lastError().text();
         return false;
     }
+    if (before.id != -1) {
+        emit ChangeNotifier::instance()->taskUpdated(before, task, ChangeNotifier::changedFields(before, task));
+    }
     return true;
 }
 
 bool Database::deleteTask(int id) {
-    QSqlQuery query;
-    query.prepare("DELETE FROM tasks WHERE id = ?");
+    const Task before = getTaskById(id);
+    QSqlQuery query = preparedQuery("DELETE FROM tasks WHERE id = ?");
     query.addBindValue(id);
 
     if (!query.exec()) {
         qWarning() << "deleteTask failed:" << query.lastError().text();
         return false;
     }
+    if (before.id != -1) emit ChangeNotifier::instance()->taskDeleted(before);
     return true;
 }
 
 QVector<Task> Database::getAllTasks() {
     QVector<Task> tasks;
-    QSqlQuery query("SELECT * FROM tasks");
+    tasks.reserve(countRows("tasks"));
+    QSqlQuery query = preparedQuery(QString("SELECT %1 FROM tasks").arg(kTaskColumns));
     
     if (!query.exec()) {
         qWarning() << "getAllTasks failed:" << query.lastError().text();
@@ -152,67 +956,345 @@ QVector<Task> Database::getAllTasks() {
     }
 
     while (query.next()) {
-        Task task;
-        task.id = query.value("id").toInt();
-        task.title = query.value("title").toString();
-        task.description = query.value("description").toString();
-        task.deadline = query.value("deadline").toDateTime();
-        task.priority = query.value("priority").toInt();
-        task.isCompleted = query.value("is_completed").toBool();
-        tasks.append(task);
+        tasks.append(taskFromQuery(query));
     }
     return tasks;
 }
 
-// TODOList Operations
-bool Database::createTODOList(TODOList& list) {
-    QSqlQuery query;
-    query.prepare(
-        "INSERT INTO todo_lists (name, date) VALUES (?, ?)"
-    );
-    query.addBindValue(list.name);
-    query.addBindValue(list.date);
+Task Database::getTaskById(int id) {
+    QSqlQuery query = preparedQuery(QString("SELECT %1 FROM tasks WHERE id = ?").arg(kTaskColumns));
+    query.addBindValue(id);
 
     if (!query.exec()) {
-        qWarning() << "createTODOList failed:" << query.lastError().text();
-        return false;
+        qWarning() << "getTaskById failed:" << query.lastError().text();
+        return Task();
     }
-
-    list.id = query.lastInsertId().toInt();
-    return true;
+    Task task = query.next() ? taskFromQuery(query) : Task();
+    query.finish();
+    return task;
 }
 
-bool Database::updateTODOList(const TODOList& list) {
-    QSqlQuery query;
-    query.prepare(
-        "UPDATE todo_lists SET name = ?, date = ? WHERE id = ?"
+QVector<Task> Database::getTasksInRange(const QDateTime& from, const QDateTime& to, bool includeCompleted) {
+    QVector<Task> tasks;
+    QSqlQuery query = preparedQuery(
+        QString("SELECT %1 FROM tasks "
+                "WHERE deadline >= ? AND deadline < ? %2"
+                "ORDER BY deadline")
+        .arg(kTaskColumns, includeCompleted ? "" : "AND is_completed = 0 ")
     );
-    query.addBindValue(list.name);
-    query.addBindValue(list.date);
-    query.addBindValue(list.id);
+    query.addBindValue(deadlineKey(from));
+    query.addBindValue(deadlineKey(to));
 
     if (!query.exec()) {
-        qWarning() << "updateTODOList failed:" << query.lastError().text();
-        return false;
+        qWarning() << "getTasksInRange failed:" << query.lastError().text();
+        return tasks;
     }
-    return true;
+
+    while (query.next()) {
+        tasks.append(taskFromQuery(query));
+    }
+    return tasks;
 }
 
-bool Database::deleteTODOList(int id) {
-    QSqlQuery query;
-    query.prepare("DELETE FROM todo_lists WHERE id = ?");
-    query.addBindValue(id);
+QMap<QDate, TaskDaySummary> Database::getMonthSummary(int year, int month, int titlesPerDay) {
+    const QDate firstOfMonth(year, month, 1);
+    if (!firstOfMonth.isValid()) return {};
+    return getDaySummaries(firstOfMonth, firstOfMonth.addMonths(1), titlesPerDay);
+}
+
+QMap<QDate, TaskDaySummary> Database::getDaySummaries(const QDate& from, const QDate& to, int titlesPerDay) {
+    QMap<QDate, TaskDaySummary> summary;
+
+    // Deadlines are ISO text, so the first 10 characters are the day. The
+    // counts come from a GROUP BY over the deadline range; each day's first
+    // few titles are numbered by a window over the same range and joined on
+    // as rows in order (group_concat wouldn't keep that order). Days with
+    // no titles wanted still get one row from the LEFT JOIN.
+    QSqlQuery query = preparedQuery(
+        "SELECT counts.day, counts.total, titles.title "
+        "FROM (SELECT substr(deadline, 1, 10) AS day, COUNT(*) AS total "
+        "      FROM tasks WHERE deadline >= ? AND deadline < ? AND is_completed = 0 "
+        "      GROUP BY day) AS counts "
+        "LEFT JOIN (SELECT day, n, title "
+        "           FROM (SELECT substr(deadline, 1, 10) AS day, title, "
+        "                        ROW_NUMBER() OVER (PARTITION BY substr(deadline, 1, 10) "
+        "                                           ORDER BY deadline, id) AS n "
+        "                 FROM tasks WHERE deadline >= ? AND deadline < ? AND is_completed = 0) "
+        "           WHERE n <= ?) AS titles ON titles.day = counts.day "
+        "ORDER BY counts.day, titles.n"
+    );
+    const QString fromKey = deadlineKey(QDateTime(from, QTime(0, 0)));
+    const QString toKey = deadlineKey(QDateTime(to, QTime(0, 0)));
+    query.addBindValue(fromKey);
+    query.addBindValue(toKey);
+    query.addBindValue(fromKey);
+    query.addBindValue(toKey);
+    query.addBindValue(titlesPerDay);
 
     if (!query.exec()) {
-        qWarning() << "deleteTODOList failed:" << query.lastError().text();
-        return false;
+        qWarning() << "getDaySummaries failed:" << query.lastError().text();
+        return summary;
     }
-    return true;
+
+    while (query.next()) {
+        TaskDaySummary& day = summary[QDate::fromString(query.value(0).toString(), Qt::ISODate)];
+        day.openCount = query.value(1).toInt();
+        if (!query.isNull(2)) {
+            day.titles.append(query.value(2).toString());
+        }
+    }
+    return summary;
 }
 
-QVector<TODOList> Database::getAllTODOLists() {
+QVector<Task> Database::searchTasks(const QString& text, int limit) {
+    QVector<Task> tasks;
+    QString match = ftsQuery(text);
+    if (match.isEmpty()) return tasks;
+
+    // Ranked ids from the FTS index, joined back to the table
+    QSqlQuery query = preparedQuery(
+        QString("SELECT %1 FROM tasks "
+                "JOIN (SELECT rowid AS hit, rank FROM tasks_fts "
+                "      WHERE tasks_fts MATCH ? ORDER BY rank LIMIT ?) ON id = hit "
+                "ORDER BY rank")
+        .arg(kTaskColumns)
+    );
+    query.addBindValue(match);
+    query.addBindValue(limit);
+
+    if (!query.exec()) {
+        qWarning() << "searchTasks failed:" << query.lastError().text();
+        return tasks;
+    }
+
+    while (query.next()) {
+        tasks.append(taskFromQuery(query));
+    }
+    return tasks;
+}
+
+QVector<Task> Database::getTasksPage(const TaskPageKey& afterKey, int limit,
+                                     TaskSort sort, const TaskFilter& filter) {
+    QVector<Task> tasks;
+    QString where, match;
+    if (!taskFilterClause(filter, where, match)) return tasks;
+
+    // Keyset condition written as a range on deadline plus a tie-break, so
+    // SQLite can seek in the deadline index instead of scanning from the top.
+    // NULL deadlines sort first ascending and last descending, so a key on
+    // a NULL deadline continues within the NULLs by id.
+    const bool ascending = sort == TaskSort::DeadlineAscending;
+    const bool hasKey = afterKey.id >= 0;
+    const bool nullKey = hasKey && !afterKey.deadline.isValid();
+    where.prepend("WHERE 1 ");
+    if (hasKey && !nullKey) {
+        where += ascending ? "AND deadline >= ? AND (deadline > ? OR id > ?) "
+                           : "AND (deadline IS NULL OR (deadline <= ? AND (deadline < ? OR id < ?))) ";
+    } else if (nullKey) {
+        where += ascending ? "AND (deadline IS NOT NULL OR id > ?) "
+                           : "AND deadline IS NULL AND id < ? ";
+    }
+
+    QSqlQuery query = preparedQuery(
+        QString("SELECT %1 FROM tasks %2ORDER BY deadline %3, id %3 LIMIT ?")
+        .arg(kTaskColumns, where, ascending ? "ASC" : "DESC")
+    );
+    bindTaskFilter(query, filter, match);
+    if (hasKey && !nullKey) {
+        query.addBindValue(deadlineKey(afterKey.deadline));
+        query.addBindValue(deadlineKey(afterKey.deadline));
+    }
+    if (hasKey) {
+        query.addBindValue(afterKey.id);
+    }
+    query.addBindValue(limit);
+
+    if (!query.exec()) {
+        qWarning() << "getTasksPage failed:" << query.lastError().text();
+        return tasks;
+    }
+
+    tasks.reserve(limit);
+    while (query.next()) {
+        tasks.append(taskFromQuery(query));
+    }
+    return tasks;
+}
+
+int Database::countTasks(const TaskFilter& filter) {
+    QString clause, match;
+    if (!taskFilterClause(filter, clause, match)) return 0;
+
+    QSqlQuery query = preparedQuery("SELECT COUNT(*) FROM tasks WHERE 1 " + clause);
+    bindTaskFilter(query, filter, match);
+
+    if (!query.exec() || !query.next()) {
+        qWarning() << "countTasks failed:" << query.lastError().text();
+        return 0;
+    }
+    const int count = query.value(0).toInt();
+    query.finish(); // the cached statement would otherwise hold a read transaction
+    return count;
+}
+
+// Archive Operations
+int Database::archiveCompletedTasks(int olderThanDays) {
+    QSqlDatabase db = connection();
+    const QDateTime now = QDateTime::currentDateTime();
+    const QString cutoff = deadlineKey(now.addDays(-olderThanDays));
+
+    if (!db.transaction()) {
+        qWarning() << "archiveCompletedTasks failed to start:" << db.lastError().text();
+        return -1;
+    }
+
+    QSqlQuery copy = preparedQuery(
+        "INSERT OR REPLACE INTO tasks_archive ("
+        "id, title, description, deadline, priority, is_completed, completed_at, archived_at) "
+        "SELECT id, title, description, deadline, priority, is_completed, completed_at, ? "
+        "FROM tasks WHERE is_completed = 1 AND completed_at < ?"
+    );
+    copy.addBindValue(deadlineKey(now));
+    copy.addBindValue(cutoff);
+
+    QSqlQuery remove = preparedQuery("DELETE FROM tasks WHERE is_completed = 1 AND completed_at < ?");
+    remove.addBindValue(cutoff);
+
+    if (!copy.exec() || !remove.exec()) {
+        qWarning() << "archiveCompletedTasks failed:" << copy.lastError().text() << remove.lastError().text();
+        db.rollback();
+        return -1;
+    }
+
+    int archived = remove.numRowsAffected();
+    if (!db.commit()) {
+        qWarning() << "archiveCompletedTasks failed to commit:" << db.lastError().text();
+        db.rollback();
+        return -1;
+    }
+    if (archived > 0) emit ChangeNotifier::instance()->tasksReset();
+    return archived;
+}
+
+bool Database::unarchiveTask(int id) {
+    QSqlDatabase db = connection();
+    if (!db.transaction()) {
+        qWarning() << "unarchiveTask failed to start:" << db.lastError().text();
+        return false;
+    }
+
+    QSqlQuery copy = preparedQuery(
+        "INSERT INTO tasks (id, title, description, deadline, priority, is_completed, completed_at) "
+        "SELECT id, title, description, deadline, priority, 0, NULL FROM tasks_archive WHERE id = ?"
+    );
+    copy.addBindValue(id);
+
+    QSqlQuery remove = preparedQuery("DELETE FROM tasks_archive WHERE id = ?");
+    remove.addBindValue(id);
+
+    if (!copy.exec() || copy.numRowsAffected() != 1 || !remove.exec()) {
+        qWarning() << "unarchiveTask failed:" << copy.lastError().text() << remove.lastError().text();
+        db.rollback();
+        return false;
+    }
+
+    if (!db.commit()) {
+        qWarning() << "unarchiveTask failed to commit:" << db.lastError().text();
+        db.rollback();
+        return false;
+    }
+    emit ChangeNotifier::instance()->taskInserted(getTaskById(id));
+    return true;
+}
+
+QVector<Task> Database::getArchivedTasks(const QString& text, int limit) {
+    QVector<Task> tasks;
+    QSqlQuery query = preparedQuery(
+        QString("SELECT %1 FROM tasks_archive "
+                "WHERE ? = '' OR title LIKE ? ESCAPE '\\' OR description LIKE ? ESCAPE '\\' "
+                "ORDER BY deadline DESC LIMIT ?")
+        .arg(kTaskColumns)
+    );
+    QString pattern = text.trimmed();
+    pattern.replace("\\", "\\\\").replace("%", "\\%").replace("_", "\\_");
+    pattern = "%" + pattern + "%";
+    query.addBindValue(text.trimmed());
+    query.addBindValue(pattern);
+    query.addBindValue(pattern);
+    query.addBindValue(limit);
+
+    if (!query.exec()) {
+        qWarning() << "getArchivedTasks failed:" << query.lastError().text();
+        return tasks;
+    }
+
+    while (query.next()) {
+        tasks.append(taskFromQuery(query));
+    }
+    return tasks;
+}
+
+QVector<Task> Database::getArchivedTasksInRange(const QDateTime& from, const QDateTime& to) {
+    QVector<Task> tasks;
+    QSqlQuery query = preparedQuery(
+        QString("SELECT %1 FROM tasks_archive "
+                "WHERE deadline >= ? AND deadline < ? "
+                "ORDER BY deadline")
+        .arg(kTaskColumns)
+    );
+    query.addBindValue(deadlineKey(from));
+    query.addBindValue(deadlineKey(to));
+
+    if (!query.exec()) {
+        qWarning() << "getArchivedTasksInRange failed:" << query.lastError().text();
+        return tasks;
+    }
+
+    while (query.next()) {
+        tasks.append(taskFromQuery(query));
+    }
+    return tasks;
+}
+
+// TODOList Operations
+bool Database::createTODOList(TODOList& list) {
+    if (!insertTODOList(list)) return false;
+    emit ChangeNotifier::instance()->todoListInserted(list.id);
+    return true;
+}
+
+bool Database::updateTODOList(const TODOList& list) {
+    QSqlQuery query = preparedQuery(
+        "UPDATE todo_lists SET name = ?, date = ? WHERE id = ?"
+    );
+    query.addBindValue(list.name);
+    query.addBindValue(list.date);
+    query.addBindValue(list.id);
+
+    if (!query.exec()) {
+        qWarning() << "updateTODOList failed:" << query.lastError().text();
+        return false;
+    }
+    emit ChangeNotifier::instance()->todoListUpdated(list.id);
+    return true;
+}
+
+bool Database::deleteTODOList(int id) {
+    QSqlQuery query = preparedQuery("DELETE FROM todo_lists WHERE id = ?");
+    query.addBindValue(id);
+
+    if (!query.exec()) {
+        qWarning() << "deleteTODOList failed:" << query.lastError().text();
+        return false;
+    }
+    emit ChangeNotifier::instance()->todoListDeleted(id);
+    return true;
+}
+
+QVector<TODOList> Database::getAllTODOLists() {
     QVector<TODOList> lists;
-    QSqlQuery query("SELECT * FROM todo_lists");
+    lists.reserve(countRows("todo_lists"));
+    QSqlQuery query = preparedQuery("SELECT id, name, date FROM todo_lists");
     
     if (!query.exec()) {
         qWarning() << "getAllTODOLists failed:" << query.lastError().text();
@@ -221,9 +1303,29 @@ QVector<TODOList> Database::getAllTODOLists() {
 
     while (query.next()) {
         TODOList list;
-        list.id = query.value("id").toInt();
-        list.name = query.value("name").toString();
-        list.date = query.value("date").toDate();
+        list.id = query.value(0).toInt();
+        list.name = query.value(1).toString();
+        list.date = query.value(2).toDate();
+        lists.append(list);
+    }
+    return lists;
+}
+
+QVector<TODOList> Database::getTODOListsForDate(const QDate& date) {
+    QVector<TODOList> lists;
+    QSqlQuery query = preparedQuery("SELECT id, name, date FROM todo_lists WHERE date = ? ORDER BY id");
+    query.addBindValue(date);
+
+    if (!query.exec()) {
+        qWarning() << "getTODOListsForDate failed:" << query.lastError().text();
+        return lists;
+    }
+
+    while (query.next()) {
+        TODOList list;
+        list.id = query.value(0).toInt();
+        list.name = query.value(1).toString();
+        list.date = query.value(2).toDate();
         lists.append(list);
     }
     return lists;
@@ -231,31 +1333,45 @@ QVector<TODOList> Database::getAllTODOLists() {
 
 // TODOItem Operations
 bool Database::createTODOItem(TODOItem& item) {
-    QSqlQuery query;
-    query.prepare(
-        "INSERT INTO todo_items ("
-        "list_id, title, description, priority, duration, completed"
-        ") VALUES (?, ?, ?, ?, ?, ?)"
-    );
-    query.addBindValue(item.listId);
-    query.addBindValue(item.title);       // NEW
-    query.addBindValue(item.description); // NEW
-    query.addBindValue(item.priority);    // NEW
-    query.addBindValue(item.duration);
-    query.addBindValue(item.completed);
+    if (!insertTODOItem(item)) return false;
+    emit ChangeNotifier::instance()->todoItemInserted(item.id);
+    return true;
+}
 
-    if (!query.exec()) {
-        qWarning() << "createTODOItem failed:" << query.lastError().text();
+bool Database::createTODOListFromTemplate(TODOList& list, int templateId) {
+    QSqlDatabase db = connection();
+    if (!db.transaction()) {
+        qWarning() << "createTODOListFromTemplate failed:" << db.lastError().text();
+        return false;
+    }
+
+    if (!insertTODOList(list)) {
+        db.rollback();
+        list.id = -1;
         return false;
     }
 
-    item.id = query.lastInsertId().toInt();
+    QSqlQuery query = preparedQuery(
+        "INSERT INTO todo_items (list_id, title, description, priority, duration) "
+        "SELECT ?, title, description, priority, duration "
+        "FROM template_items WHERE template_id = ? ORDER BY id"
+    );
+    query.addBindValue(list.id);
+    query.addBindValue(templateId);
+
+    if (!query.exec() || !db.commit()) {
+        qWarning() << "createTODOListFromTemplate failed:" << query.lastError().text() << db.lastError().text();
+        db.rollback();
+        list.id = -1;
+        return false;
+    }
+    // The list arrives with its items
+    emit ChangeNotifier::instance()->todoListInserted(list.id);
     return true;
 }
 
 bool Database::updateTODOItem(const TODOItem& item) {
-    QSqlQuery query;
-    query.prepare(
+    QSqlQuery query = preparedQuery(
         "UPDATE todo_items SET "
         "list_id = ?, "
         "title = ?, "              // NEW
@@ -277,25 +1393,25 @@ bool Database::updateTODOItem(const TODOItem& item) {
         qWarning() << "updateTODOItem failed:" << query.lastError().text();
         return false;
     }
+    emit ChangeNotifier::instance()->todoItemUpdated(item.id);
     return true;
 }
 
 bool Database::deleteTODOItem(int id) {
-    QSqlQuery query;
-    query.prepare("DELETE FROM todo_items WHERE id = ?");
+    QSqlQuery query = preparedQuery("DELETE FROM todo_items WHERE id = ?");
     query.addBindValue(id);
 
     if (!query.exec()) {
         qWarning() << "deleteTODOItem failed:" << query.lastError().text();
         return false;
     }
+    emit ChangeNotifier::instance()->todoItemDeleted(id);
     return true;
 }
 
 QVector<TODOItem> Database::getItemsForList(int listId) {
     QVector<TODOItem> items;
-    QSqlQuery query;
-    query.prepare("SELECT * FROM todo_items WHERE list_id = ?");
+    QSqlQuery query = preparedQuery(QString("SELECT %1 FROM todo_items WHERE list_id = ?").arg(kTODOItemColumns));
     query.addBindValue(listId);
     
     if (!query.exec()) {
@@ -304,49 +1420,99 @@ QVector<TODOItem> Database::getItemsForList(int listId) {
     }
 
     while (query.next()) {
-        TODOItem item;
-        item.id = query.value("id").toInt();
-        item.listId = query.value("list_id").toInt();
-        item.title = query.value("title").toString();         // NEW
-        item.description = query.value("description").toString(); // NEW
-        item.priority = query.value("priority").toInt();      // NEW
-        item.duration = query.value("duration").toInt();
-        item.completed = query.value("completed").toBool();
-        items.append(item);
+        items.append(todoItemFromQuery(query));
     }
     return items;
 }
 
-// Template Operations
-bool Database::createTemplate(Template& templ) {
-    QSqlQuery query;
-    query.prepare("INSERT INTO templates (name) VALUES (?)");
-    query.addBindValue(templ.name);
-    
+QVector<TODOItem> Database::getItemsForDate(const QDate& date) {
+    return getItemsForDateRange(date, date).value(date);
+}
+
+QMap<QDate, QVector<TODOItem>> Database::getItemsForDateRange(const QDate& from, const QDate& to) {
+    QMap<QDate, QVector<TODOItem>> itemsByDate;
+    QSqlQuery query = preparedQuery(
+        "SELECT i.id, i.list_id, i.title, i.description, i.priority, i.duration, i.completed, "
+        "l.date FROM todo_lists l "
+        "JOIN todo_items i ON i.list_id = l.id "
+        "WHERE l.date >= ? AND l.date <= ? "
+        "ORDER BY l.date, l.id, i.id"
+    );
+    query.addBindValue(from);
+    query.addBindValue(to);
+
     if (!query.exec()) {
-        qWarning() << "createTemplate failed:" << query.lastError().text();
-        return false;
+        qWarning() << "getItemsForDateRange failed:" << query.lastError().text();
+        return itemsByDate;
     }
-    
-    templ.id = query.lastInsertId().toInt();
+
+    while (query.next()) {
+        itemsByDate[query.value(7).toDate()].append(todoItemFromQuery(query));
+    }
+    return itemsByDate;
+}
+
+QVector<TODOItem> Database::searchTODOItems(const QString& text, int limit) {
+    QVector<TODOItem> items;
+    QString match = ftsQuery(text);
+    if (match.isEmpty()) return items;
+
+    QSqlQuery query = preparedQuery(
+        QString("SELECT %1 FROM todo_items "
+                "JOIN (SELECT rowid AS hit, rank FROM todo_items_fts "
+                "      WHERE todo_items_fts MATCH ? ORDER BY rank LIMIT ?) ON id = hit "
+                "ORDER BY rank")
+        .arg(kTODOItemColumns)
+    );
+    query.addBindValue(match);
+    query.addBindValue(limit);
+
+    if (!query.exec()) {
+        qWarning() << "searchTODOItems failed:" << query.lastError().text();
+        return items;
+    }
+
+    while (query.next()) {
+        items.append(todoItemFromQuery(query));
+    }
+    return items;
+}
+
+TODOItem Database::getTODOItemById(int id) {
+    QSqlQuery query = preparedQuery(QString("SELECT %1 FROM todo_items WHERE id = ?").arg(kTODOItemColumns));
+    query.addBindValue(id);
+
+    if (!query.exec()) {
+        qWarning() << "getTODOItemById failed:" << query.lastError().text();
+        return TODOItem();
+    }
+    TODOItem item = query.next() ? todoItemFromQuery(query) : TODOItem();
+    query.finish();
+    return item;
+}
+
+// Template Operations
+bool Database::createTemplate(Template& templ) {
+    if (!insertTemplate(templ)) return false;
+    emit ChangeNotifier::instance()->templateInserted(templ.id);
     return true;
 }
 
 bool Database::deleteTemplate(int id) {
-    QSqlQuery query;
-    query.prepare("DELETE FROM templates WHERE id = ?");
+    QSqlQuery query = preparedQuery("DELETE FROM templates WHERE id = ?");
     query.addBindValue(id);
     
     if (!query.exec()) {
         qWarning() << "deleteTemplate failed:" << query.lastError().text();
         return false;
     }
+    emit ChangeNotifier::instance()->templateDeleted(id);
     return true;
 }
 
 QVector<Template> Database::getAllTemplates() {
     QVector<Template> templates;
-    QSqlQuery query("SELECT * FROM templates");
+    QSqlQuery query = preparedQuery("SELECT id, name FROM templates");
     
     if (!query.exec()) {
         qWarning() << "getAllTemplates failed:" << query.lastError().text();
@@ -355,8 +1521,8 @@ QVector<Template> Database::getAllTemplates() {
 
     while (query.next()) {
         Template templ;
-        templ.id = query.value("id").toInt();
-        templ.name = query.value("name").toString();
+        templ.id = query.value(0).toInt();
+        templ.name = query.value(1).toString();
         templates.append(templ);
     }
     return templates;
@@ -364,43 +1530,57 @@ QVector<Template> Database::getAllTemplates() {
 
 // Template Item Operations
 bool Database::createTemplateItem(TemplateItem& item) {
-    QSqlQuery query;
-    query.prepare(
-        "INSERT INTO template_items ("
-        "template_id, title, description, priority, duration"
-        ") VALUES (?, ?, ?, ?, ?)"
-    );
-    query.addBindValue(item.templateId);
-    query.addBindValue(item.title);
-    query.addBindValue(item.description);
-    query.addBindValue(item.priority);
-    query.addBindValue(item.duration);
+    if (!insertTemplateItem(item)) return false;
+    emit ChangeNotifier::instance()->templateUpdated(item.templateId);
+    return true;
+}
 
-    if (!query.exec()) {
-        qWarning() << "createTemplateItem failed:" << query.lastError().text();
+bool Database::createTemplateFromList(Template& templ, int listId) {
+    QSqlDatabase db = connection();
+    if (!db.transaction()) {
+        qWarning() << "createTemplateFromList failed:" << db.lastError().text();
         return false;
     }
 
-    item.id = query.lastInsertId().toInt();
+    if (!insertTemplate(templ)) {
+        db.rollback();
+        templ.id = -1;
+        return false;
+    }
+
+    QSqlQuery query = preparedQuery(
+        "INSERT INTO template_items (template_id, title, description, priority, duration) "
+        "SELECT ?, title, description, priority, duration "
+        "FROM todo_items WHERE list_id = ? ORDER BY id"
+    );
+    query.addBindValue(templ.id);
+    query.addBindValue(listId);
+
+    if (!query.exec() || !db.commit()) {
+        qWarning() << "createTemplateFromList failed:" << query.lastError().text() << db.lastError().text();
+        db.rollback();
+        templ.id = -1;
+        return false;
+    }
+    emit ChangeNotifier::instance()->templateInserted(templ.id);
     return true;
 }
 
 bool Database::deleteTemplateItemsForTemplate(int templateId) {
-    QSqlQuery query;
-    query.prepare("DELETE FROM template_items WHERE template_id = ?");
+    QSqlQuery query = preparedQuery("DELETE FROM template_items WHERE template_id = ?");
     query.addBindValue(templateId);
     
     if (!query.exec()) {
         qWarning() << "deleteTemplateItemsForTemplate failed:" << query.lastError().text();
         return false;
     }
+    emit ChangeNotifier::instance()->templateUpdated(templateId);
     return true;
 }
 
 QVector<TemplateItem> Database::getItemsForTemplate(int templateId) {
     QVector<TemplateItem> items;
-    QSqlQuery query;
-    query.prepare("SELECT * FROM template_items WHERE template_id = ?");
+    QSqlQuery query = preparedQuery(QString("SELECT %1 FROM template_items WHERE template_id = ?").arg(kTemplateItemColumns));
     query.addBindValue(templateId);
     
     if (!query.exec()) {
@@ -409,102 +1589,849 @@ QVector<TemplateItem> Database::getItemsForTemplate(int templateId) {
     }
 
     while (query.next()) {
-        TemplateItem item;
-        item.id = query.value("id").toInt();
-        item.templateId = query.value("template_id").toInt();
-        item.title = query.value("title").toString();
-        item.description = query.value("description").toString();
-        item.priority = query.value("priority").toInt();
-        item.duration = query.value("duration").toInt();
-        items.append(item);
+        items.append(templateItemFromQuery(query));
     }
     return items;
 }
 
+Database::StorageConfig Database::storageConfig() {
+    StorageConfig config;
+
+    // Config file next to the database, e.g.
+    //   [storage]
+    //   journal_mode=WAL
+    //   synchronous=NORMAL
+    //   cache_size_kib=16384
+    //   mmap_size=268435456
+    //   temp_store=MEMORY
+    //   archive_after_days=30
+    QString configPath = QFileInfo(getDatabasePath()).absolutePath() + "/taskmanager.ini";
+    QSettings settings(configPath, QSettings::IniFormat);
+    settings.beginGroup("storage");
+
+    // Environment variables take precedence over the config file
+    auto setting = [&settings](const char* key, const char* env) {
+        QString value = qEnvironmentVariable(env);
+        return value.isEmpty() ? settings.value(key).toString() : value;
+    };
+
+    config.journalMode = pickSetting(setting("journal_mode", "TASKMANAGER_JOURNAL_MODE"),
+                                     {"DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF"},
+                                     config.journalMode);
+    config.synchronous = pickSetting(setting("synchronous", "TASKMANAGER_SYNCHRONOUS"),
+                                     {"OFF", "NORMAL", "FULL", "EXTRA"},
+                                     config.synchronous);
+    config.tempStore = pickSetting(setting("temp_store", "TASKMANAGER_TEMP_STORE"),
+                                   {"DEFAULT", "FILE", "MEMORY"},
+                                   config.tempStore);
+
+    bool ok = false;
+    int cacheSize = setting("cache_size_kib", "TASKMANAGER_CACHE_SIZE_KIB").toInt(&ok);
+    if (ok && cacheSize > 0) config.cacheSizeKiB = cacheSize;
+
+    qint64 mmapSize = setting("mmap_size", "TASKMANAGER_MMAP_SIZE").toLongLong(&ok);
+    if (ok && mmapSize >= 0) config.mmapSize = mmapSize;
+
+    int archiveAfterDays = setting("archive_after_days", "TASKMANAGER_ARCHIVE_AFTER_DAYS").toInt(&ok);
+    if (ok && archiveAfterDays >= 0) config.archiveAfterDays = archiveAfterDays;
+
+    return config;
+}
+
 QString Database::getDatabasePath() {
     QString dataDir = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
     return dataDir + "/taskmanager.db";
 }
 
-bool Database::backupDatabase(const QString& backupPath) {
-    QString dbPath = getDatabasePath();
-    return QFile::copy(dbPath, backupPath);
+bool Database::backupDatabase(const QString& backupPath, const ProgressCallback& progress) {
+    // Build the backup next to the target; it only replaces an existing
+    // file once it has been verified
+    const QString partialPath = backupPath + ".part";
+    QFile::remove(partialPath);
+
+    auto fail = [&](const QString& error) {
+        qWarning() << "backupDatabase failed:" << error;
+        QFile::remove(partialPath);
+        return false;
+    };
+
+    if (progress) {
+        progress(0, 2);
+    }
+
+    // VACUUM INTO copies a consistent snapshot of the database into a new,
+    // compacted file, inside one read transaction on this connection, so
+    // writers elsewhere carry on in WAL mode. It runs through the SQLite
+    // that owns the connection (3.27 or later).
+    QSqlQuery query(connection());
+    query.prepare("VACUUM INTO ?");
+    query.addBindValue(partialPath);
+    if (!query.exec()) {
+        return fail(query.lastError().text());
+    }
+    query.finish();
+
+    if (progress) {
+        progress(1, 2);
+    }
+
+    // The copy keeps the source's WAL flag; store it as a standalone file
+    bool verified = withDatabaseFile(partialPath, QString(), [](QSqlDatabase& db) {
+        QSqlQuery pragma(db);
+        return pragma.exec("PRAGMA journal_mode = DELETE") && passesIntegrityCheck(db);
+    });
+    if (!verified) {
+        return fail("integrity check failed");
+    }
+
+    QFile::remove(backupPath);
+    if (!QFile::rename(partialPath, backupPath)) {
+        return fail("could not move backup into place");
+    }
+    if (progress) {
+        progress(2, 2);
+    }
+    return true;
 }
 
-bool Database::restoreDatabase(const QString& backupPath) {
-    QString dbPath = getDatabasePath();
-    QFile::remove(dbPath);
-    return QFile::copy(backupPath, dbPath);
+bool Database::restoreDatabase(const QString& backupPath, const ProgressCallback& progress) {
+    if (!isValidBackup(backupPath)) {
+        return false;
+    }
+
+    // Stage the copy next to the live file so the final swap is a rename
+    // on the same filesystem
+    QFile source(backupPath);
+    QSaveFile staged(getDatabasePath());
+    if (!source.open(QIODevice::ReadOnly) || !staged.open(QIODevice::WriteOnly)) {
+        qWarning() << "restoreDatabase failed:" << source.errorString() << staged.errorString();
+        return false;
+    }
+    const qint64 total = source.size();
+    qint64 copied = 0;
+    while (!source.atEnd()) {
+        QByteArray chunk = source.read(1024 * 1024);
+        if (chunk.isEmpty() || staged.write(chunk) != chunk.size()) {
+            qWarning() << "restoreDatabase failed while copying:" << source.errorString() << staged.errorString();
+            staged.cancelWriting();
+            return false;
+        }
+        copied += chunk.size();
+        if (progress) progress(copied, total);
+    }
+
+    // Close so nothing reads through the old file handle; closing also
+    // folds the WAL back into the old file
+    suspendConnection();
+
+    // A leftover WAL would be replayed on top of the restored file
+    const QString dbPath = getDatabasePath();
+    QFile::remove(dbPath + "-wal");
+    QFile::remove(dbPath + "-shm");
+
+    bool swapped = staged.commit();
+    if (!swapped) {
+        qWarning() << "restoreDatabase failed to replace the database:" << staged.errorString();
+    }
+
+    // Reopen either way; on failure this is the untouched old database
+    QSqlDatabase db = connection();
+    if (!openDatabase(db) || !migrate(db)) {
+        qCritical() << "restoreDatabase could not reopen the database";
+        return false;
+    }
+    if (swapped) emit ChangeNotifier::instance()->dataReset();
+    return swapped;
+}
+
+bool Database::exportToSQL(const QString& filePath, const ProgressCallback& progress) {
+    // Keeps each INSERT under SQLite's older 999 bind-parameter limit once
+    // the importer parameterizes it
+    const int rowsPerInsert = 100;
+    const int flushThreshold = 4 * 1024 * 1024;
+
+    // Written to a temporary file that replaces filePath only once complete
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "exportToSQL failed:" << file.errorString();
+        return false;
+    }
+
+    // One read transaction, so the dump is a consistent snapshot even while
+    // other connections keep writing
+    QSqlDatabase db = connection();
+    if (!db.transaction()) {
+        qWarning() << "exportToSQL failed:" << db.lastError().text();
+        return false;
+    }
+    auto fail = [&](const QString& error) {
+        qWarning() << "exportToSQL failed:" << error;
+        db.rollback();
+        file.cancelWriting();
+        return false;
+    };
+
+    qint64 total = 0;
+    for (const QString& table : dataTables()) {
+        total += countRows(table);
+    }
+    qint64 done = 0;
+
+    // Rows are encoded straight into a large UTF-8 buffer that is written
+    // out in big chunks, instead of one formatted QString per row
+    QByteArray buffer;
+    buffer.reserve(flushThreshold + 64 * 1024);
+    auto flush = [&]() {
+        if (file.write(buffer) != buffer.size()) return false;
+        buffer.clear();
+        return true;
+    };
+
+    // Data only: the schema belongs to the migrations, and replacing rows
+    // (rather than tables) keeps the FTS triggers in place on import
+    buffer += "PRAGMA foreign_keys=OFF;\n";
+    buffer += "BEGIN TRANSACTION;\n";
+
+    for (const QString& table : dataTables()) {
+        const QStringList columns = tableColumns(db, table);
+        const QByteArray insertHead = QString("INSERT INTO %1 (%2) VALUES\n")
+                                      .arg(table, columns.join(", ")).toUtf8();
+        buffer += "DELETE FROM " + table.toUtf8() + ";\n";
+
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        if (!query.exec(QString("SELECT %1 FROM %2 ORDER BY rowid").arg(columns.join(", "), table))) {
+            return fail(query.lastError().text());
+        }
+
+        int rowsInStatement = 0;
+        while (query.next()) {
+            buffer += rowsInStatement == 0 ? insertHead : QByteArray(",\n");
+            buffer += '(';
+            for (int i = 0; i < columns.size(); ++i) {
+                if (i > 0) buffer += ',';
+                appendSqlLiteral(buffer, query.value(i));
+            }
+            buffer += ')';
+
+            if (++rowsInStatement == rowsPerInsert) {
+                buffer += ";\n";
+                rowsInStatement = 0;
+            }
+            ++done;
+
+            if (buffer.size() >= flushThreshold) {
+                if (!flush()) {
+                    return fail(file.errorString());
+                }
+                if (progress) progress(done, total);
+            }
+        }
+        if (rowsInStatement > 0) buffer += ";\n";
+    }
+
+    buffer += "COMMIT;\n";
+    buffer += "PRAGMA foreign_keys=ON;\n";
+    if (!db.commit()) {
+        return fail(db.lastError().text());
+    }
+
+    if (!flush() || !file.commit()) {
+        qWarning() << "exportToSQL failed:" << file.errorString();
+        return false;
+    }
+    if (progress) progress(total, total);
+    return true;
 }
 
-bool Database::exportToSQL(const QString& filePath) {
+bool Database::importFromSQL(const QString& filePath, const ProgressCallback& progress, int commitInterval) {
+    // SQLite's default limit on bound parameters in older versions; larger
+    // statements are executed as written
+    const int maxBindValues = 999;
+
     QFile file(filePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text))
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "importFromSQL failed:" << file.errorString();
         return false;
+    }
 
-    QTextStream out(&file);
-    QSqlDatabase db = QSqlDatabase::database();
-    
-    // Export schema
-    out << "PRAGMA foreign_keys=OFF;\n";
-    out << "BEGIN TRANSACTION;\n";
-    
-    // Export tables
-    QStringList tables = db.tables();
+    QSqlDatabase db = connection();
+    if (!db.transaction()) {
+        qWarning() << "importFromSQL failed:" << db.lastError().text();
+        return false;
+    }
+
+    // Prepared statements for this import, keyed by parameterized SQL, so
+    // every INSERT of the same shape re-uses one statement
+    QHash<QString, QSqlQuery> statements;
+    bool committed = false;
+    auto fail = [&](const QString& error) {
+        qWarning() << "importFromSQL failed:" << error;
+        statements.clear();
+        db.rollback();
+        if (committed) emit ChangeNotifier::instance()->dataReset();
+        return false;
+    };
+
+    const qint64 total = file.size();
+    SqlStatementReader reader(&file);
+    SqlStatementReader::Statement statement;
+    int sinceCommit = 0;
+
+    while (reader.next(statement)) {
+        // The import manages its own transaction
+        const QString keyword = statement.sql.section(QRegExp("\\s+"), 0, 0).toUpper();
+        if (keyword == "BEGIN" || keyword == "COMMIT" || keyword == "END" || keyword == "ROLLBACK") {
+            continue;
+        }
+
+        if (!statement.parameterized.isEmpty() && statement.values.size() <= maxBindValues) {
+            auto it = statements.find(statement.parameterized);
+            if (it == statements.end()) {
+                QSqlQuery query(db);
+                query.setForwardOnly(true);
+                if (!query.prepare(statement.parameterized)) {
+                    return fail(query.lastError().text());
+                }
+                it = statements.insert(statement.parameterized, query);
+            }
+
+            QSqlQuery& query = it.value();
+            for (const QVariant& value : statement.values) {
+                query.addBindValue(value);
+            }
+            if (!query.exec()) {
+                return fail(query.lastError().text());
+            }
+        } else {
+            QSqlQuery query(db);
+            if (!query.exec(statement.sql)) {
+                return fail(query.lastError().text());
+            }
+        }
+
+        // Optional intermediate commits keep the WAL bounded on huge imports,
+        // at the cost of leaving a partial import behind on failure
+        if (commitInterval > 0 && ++sinceCommit >= commitInterval) {
+            if (!db.commit()) {
+                return fail(db.lastError().text());
+            }
+            committed = true;
+            if (!db.transaction()) {
+                return fail(db.lastError().text());
+            }
+            sinceCommit = 0;
+        }
+
+        if (progress) progress(reader.bytesRead(), total);
+    }
+
+    statements.clear();
+    if (!db.commit()) {
+        return fail(db.lastError().text());
+    }
+    emit ChangeNotifier::instance()->dataReset();
+    if (progress) progress(total, total);
+    return true;
+}
+
+bool Database::exportSnapshot(const QString& filePath, const ProgressCallback& progress) {
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "exportSnapshot failed:" << file.errorString();
+        return false;
+    }
+
+    // One read transaction, so the snapshot is consistent
+    QSqlDatabase db = connection();
+    if (!db.transaction()) {
+        qWarning() << "exportSnapshot failed:" << db.lastError().text();
+        return false;
+    }
+    auto fail = [&](const QString& error) {
+        qWarning() << "exportSnapshot failed:" << error;
+        db.rollback();
+        file.cancelWriting();
+        return false;
+    };
+
+    const QStringList tables = dataTables();
+    qint64 total = 0;
     for (const QString& table : tables) {
-        QSqlQuery query(QString("SELECT sql FROM sqlite_master WHERE name='%1'").arg(table));
-        if (query.next()) {
-            out << query.value(0).toString() << ";\n";
+        total += countRows(table);
+    }
+    qint64 done = 0;
+
+    SnapshotWriter writer(&file);
+    if (!writer.begin(schemaVersion(db), tables.size())) {
+        return fail(file.errorString());
+    }
+
+    // Rows are encoded column by column into per-chunk blocks that are
+    // written out every kChunkRows rows, so memory stays bounded however
+    // large the table is
+    for (const QString& table : tables) {
+        const QStringList columns = tableColumns(db, table);
+        if (!writer.beginTable(table, columns, quint64(countRows(table)))) {
+            return fail(file.errorString());
+        }
+
+        QVector<QByteArray> chunk(columns.size());
+        for (QByteArray& block : chunk) {
+            block.reserve(SnapshotWriter::kChunkRows * 16);
         }
-        
-        // Export data
-        query.exec(QString("SELECT * FROM %1").arg(table));
+        quint32 chunkRows = 0;
+        auto flush = [&]() {
+            if (chunkRows == 0) return true;
+            if (!writer.writeChunk(chunkRows, chunk)) return false;
+            for (QByteArray& block : chunk) {
+                block.resize(0); // keeps the reserved capacity
+            }
+            chunkRows = 0;
+            return true;
+        };
+
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        if (!query.exec(QString("SELECT %1 FROM %2 ORDER BY rowid").arg(columns.join(", "), table))) {
+            return fail(query.lastError().text());
+        }
+
         while (query.next()) {
-            QStringList values;
-            for (int i = 0; i < query.record().count(); ++i) {
-                QVariant value = query.value(i);
-                if (value.isNull()) {
-                    values << "NULL";
-                } else if (value.type() == QVariant::String) {
-                    values << "'" + value.toString().replace("'", "''") + "'";
-                } else {
-                    values << value.toString();
+            for (int i = 0; i < columns.size(); ++i) {
+                SnapshotWriter::appendValue(chunk[i], query.value(i));
+            }
+            if (++chunkRows == quint32(SnapshotWriter::kChunkRows) && !flush()) {
+                return fail(file.errorString());
+            }
+            if (progress && ++done % 1000 == 0) progress(done, total);
+        }
+        if (!flush()) {
+            return fail(file.errorString());
+        }
+    }
+    if (!db.commit()) {
+        return fail(db.lastError().text());
+    }
+
+    if (!writer.finish() || !file.commit()) {
+        qWarning() << "exportSnapshot failed:" << file.errorString();
+        return false;
+    }
+    if (progress) progress(total, total);
+    return true;
+}
+
+bool Database::importSnapshot(const QString& filePath, const ProgressCallback& progress) {
+    // SQLite's default limit on bound parameters in older versions
+    const int maxBindValues = 999;
+
+    // Validates the whole file (structure and checksum) before touching the
+    // database
+    SnapshotReader reader;
+    if (!reader.open(filePath)) {
+        qWarning() << "importSnapshot failed:" << reader.errorString();
+        return false;
+    }
+
+    QSqlDatabase db = connection();
+    if (reader.schemaVersion() > schemaVersion(db)) {
+        qWarning() << "importSnapshot failed: snapshot schema" << reader.schemaVersion()
+                   << "is newer than this database";
+        return false;
+    }
+
+    if (!db.transaction()) {
+        qWarning() << "importSnapshot failed:" << db.lastError().text();
+        return false;
+    }
+    auto fail = [&](const QString& error) {
+        qWarning() << "importSnapshot failed:" << error;
+        db.rollback();
+        return false;
+    };
+
+    const qint64 total = qint64(reader.totalRows());
+    qint64 done = 0;
+
+    // The FTS indexes are rebuilt once after loading instead of row by row
+    QStringList restoreFts;
+    QString error;
+    if (!dropFtsTriggers(db, restoreFts, error)) {
+        return fail(error);
+    }
+
+    // A snapshot replaces the data wholesale: every table it covers is
+    // emptied, even one the file has no rows for. Children go first.
+    const QStringList tables = dataTables();
+    for (auto it = tables.crbegin(); it != tables.crend(); ++it) {
+        QSqlQuery clear(db);
+        if (!clear.exec("DELETE FROM " + *it)) {
+            return fail(clear.lastError().text());
+        }
+    }
+
+    for (const SnapshotReader::Table& table : reader.tables()) {
+        if (!dataTables().contains(table.name)) {
+            qWarning() << "importSnapshot: skipping unknown table" << table.name;
+            continue;
+        }
+
+        // Columns the current schema no longer has are read but dropped;
+        // ones the snapshot lacks take their defaults
+        const QStringList existing = tableColumns(db, table.name);
+        QVector<bool> keep;
+        QStringList columns;
+        for (const QString& column : table.columns) {
+            keep.append(existing.contains(column));
+            if (keep.last()) columns << column;
+        }
+        if (columns.isEmpty()) continue;
+
+        // Rows go in as multi-row INSERTs of up to maxBindValues values,
+        // one prepared statement rebound for every full batch
+        const int rowsPerInsert = qMax(1, maxBindValues / columns.size());
+        const QString rowPlaceholders = "(?" + QString(", ?").repeated(columns.size() - 1) + ")";
+        auto prepareInsert = [&](QSqlQuery& insert, int rows) {
+            const QString values = rowPlaceholders + QString(", " + rowPlaceholders).repeated(rows - 1);
+            return insert.prepare(QString("INSERT INTO %1 (%2) VALUES %3")
+                                  .arg(table.name, columns.join(", "), values));
+        };
+        QSqlQuery insert(db);
+        if (!prepareInsert(insert, rowsPerInsert)) {
+            return fail(insert.lastError().text());
+        }
+
+        QVector<QVariant> pending;
+        pending.reserve(rowsPerInsert * columns.size());
+        int pendingRows = 0;
+        auto flush = [&](QSqlQuery& query) {
+            for (int i = 0; i < pending.size(); ++i) {
+                query.bindValue(i, pending.at(i));
+            }
+            pending.resize(0); // keeps the reserved capacity
+            pendingRows = 0;
+            return query.exec();
+        };
+
+        QVariant value;
+        for (const SnapshotReader::Chunk& chunk : table.chunks) {
+            QVector<SnapshotReader::Cursor> cursors;
+            for (const SnapshotReader::Column& column : chunk.columns) {
+                cursors.append(SnapshotReader::Cursor(column));
+            }
+
+            for (quint64 row = 0; row < chunk.rowCount; ++row) {
+                for (int c = 0; c < cursors.size(); ++c) {
+                    if (!cursors[c].next(value)) {
+                        return fail(QString("corrupt value in %1.%2").arg(table.name, table.columns.at(c)));
+                    }
+                    if (keep.at(c)) pending.append(value);
+                }
+                if (++pendingRows == rowsPerInsert && !flush(insert)) {
+                    return fail(insert.lastError().text());
                 }
+                if (progress && ++done % 1000 == 0) progress(done, total);
+            }
+        }
+
+        if (pendingRows > 0) {
+            QSqlQuery tail(db);
+            if (!prepareInsert(tail, pendingRows) || !flush(tail)) {
+                return fail(tail.lastError().text());
             }
-            out << QString("INSERT INTO %1 VALUES (%2);\n")
-                   .arg(table)
-                   .arg(values.join(","));
         }
     }
-    
-    out << "COMMIT;\n";
-    out << "PRAGMA foreign_keys=ON;";
+
+    for (const QString& statement : restoreFts) {
+        QSqlQuery query(db);
+        if (!query.exec(statement)) {
+            return fail(query.lastError().text());
+        }
+    }
+
+    if (!db.commit()) {
+        return fail(db.lastError().text());
+    }
+    emit ChangeNotifier::instance()->dataReset();
+    if (progress) progress(total, total);
+    return true;
+}
+
+bool Database::exportToJsonLines(const QString& filePath, const ProgressCallback& progress,
+                                 TransferStats* stats) {
+    const int flushThreshold = 4 * 1024 * 1024;
+    QElapsedTimer timer;
+    timer.start();
+
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qWarning() << "exportToJsonLines failed:" << file.errorString();
+        return false;
+    }
+
+    QSqlDatabase db = connection();
+    if (!db.transaction()) {
+        qWarning() << "exportToJsonLines failed:" << db.lastError().text();
+        return false;
+    }
+    auto fail = [&](const QString& error) {
+        qWarning() << "exportToJsonLines failed:" << error;
+        db.rollback();
+        file.cancelWriting();
+        return false;
+    };
+
+    qint64 total = 0;
+    for (const QString& table : dataTables()) {
+        total += countRows(table);
+    }
+    qint64 done = 0;
+
+    QByteArray buffer;
+    buffer.reserve(flushThreshold + 64 * 1024);
+
+    for (const QString& table : dataTables()) {
+        const QStringList columns = tableColumns(db, table);
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        if (!query.exec(QString("SELECT %1 FROM %2 ORDER BY rowid").arg(columns.join(", "), table))) {
+            return fail(query.lastError().text());
+        }
+
+        while (query.next()) {
+            QJsonObject row;
+            for (int i = 0; i < columns.size(); ++i) {
+                row.insert(columns.at(i), QJsonValue::fromVariant(query.value(i)));
+            }
+            QJsonObject line;
+            line.insert("table", table);
+            line.insert("row", row);
+            buffer += QJsonDocument(line).toJson(QJsonDocument::Compact);
+            buffer += '\n';
+            ++done;
+
+            if (buffer.size() >= flushThreshold) {
+                if (file.write(buffer) != buffer.size()) return fail(file.errorString());
+                buffer.clear();
+                if (progress) progress(done, total);
+            }
+        }
+    }
+    if (!db.commit()) {
+        return fail(db.lastError().text());
+    }
+
+    if (file.write(buffer) != buffer.size() || !file.commit()) {
+        qWarning() << "exportToJsonLines failed:" << file.errorString();
+        return false;
+    }
+    if (progress) progress(total, total);
+    reportTransfer("exportToJsonLines", done, timer, stats);
     return true;
 }
 
-bool Database::importFromSQL(const QString& filePath) {
+bool Database::importFromJsonLines(const QString& filePath, const ProgressCallback& progress,
+                                   TransferStats* stats, int batchSize) {
+    QElapsedTimer timer;
+    timer.start();
+
     QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "importFromJsonLines failed:" << file.errorString();
         return false;
+    }
 
-    QSqlDatabase db = QSqlDatabase::database();
-    db.transaction();
-    
-    QTextStream in(&file);
-    QString sql = in.readAll();
-    
-    // Split into individual commands
-    QStringList commands = sql.split(';', Qt::SkipEmptyParts);
-    for (QString command : commands) {
-        command = command.trimmed();
-        if (command.isEmpty()) continue;
-        
-        QSqlQuery query;
-        if (!query.exec(command)) {
-            db.rollback();
+    const qint64 total = file.size();
+    BatchInserter inserter(connection(), batchSize);
+    qint64 lineNumber = 0;
+
+    while (!file.atEnd()) {
+        const QByteArray line = file.readLine().trimmed();
+        ++lineNumber;
+        if (line.isEmpty()) continue;
+
+        QJsonParseError parseError;
+        const QJsonObject object = QJsonDocument::fromJson(line, &parseError).object();
+        if (parseError.error != QJsonParseError::NoError) {
+            qWarning() << "importFromJsonLines failed at line" << lineNumber << ":" << parseError.errorString();
+            return false;
+        }
+
+        const QJsonObject row = object.value("row").toObject();
+        QStringList columns;
+        QVariantList values;
+        for (auto it = row.constBegin(); it != row.constEnd(); ++it) {
+            columns << it.key();
+            values << jsonToVariant(it.value());
+        }
+
+        if (!inserter.insert(object.value("table").toString(), columns, values)) {
+            qWarning() << "importFromJsonLines failed at line" << lineNumber << ":" << inserter.errorString();
             return false;
         }
+        if (progress && lineNumber % 1000 == 0) progress(file.pos(), total);
     }
-    
-    return db.commit();
-}
\ No newline at end of file
+
+    if (!inserter.commit()) {
+        qWarning() << "importFromJsonLines failed:" << inserter.errorString();
+        return false;
+    }
+    if (progress) progress(total, total);
+    reportTransfer("importFromJsonLines", inserter.rows(), timer, stats);
+    return true;
+}
+
+bool Database::exportToCsv(const QString& directory, const ProgressCallback& progress,
+                           TransferStats* stats) {
+    const int flushThreshold = 4 * 1024 * 1024;
+    QElapsedTimer timer;
+    timer.start();
+
+    QDir dir(directory);
+    if (!dir.exists() && !dir.mkpath(".")) {
+        qWarning() << "exportToCsv failed: could not create" << directory;
+        return false;
+    }
+
+    // One read transaction across all files, so they agree with each other
+    QSqlDatabase db = connection();
+    if (!db.transaction()) {
+        qWarning() << "exportToCsv failed:" << db.lastError().text();
+        return false;
+    }
+    auto fail = [&](const QString& error) {
+        qWarning() << "exportToCsv failed:" << error;
+        db.rollback();
+        return false;
+    };
+
+    qint64 total = 0;
+    for (const QString& table : dataTables()) {
+        total += countRows(table);
+    }
+    qint64 done = 0;
+
+    QByteArray buffer;
+    buffer.reserve(flushThreshold + 64 * 1024);
+
+    // The files replace their old versions only after the read transaction
+    // has committed, so they stay a consistent set
+    std::vector<std::unique_ptr<QSaveFile>> files;
+
+    for (const QString& table : dataTables()) {
+        files.emplace_back(new QSaveFile(dir.filePath(table + ".csv")));
+        QSaveFile& file = *files.back();
+        if (!file.open(QIODevice::WriteOnly)) {
+            return fail(file.errorString());
+        }
+
+        const QStringList columns = tableColumns(db, table);
+        buffer.clear();
+        for (int i = 0; i < columns.size(); ++i) {
+            if (i > 0) buffer += ',';
+            CsvReader::appendField(buffer, columns.at(i));
+        }
+        buffer += '\n';
+
+        QSqlQuery query(db);
+        query.setForwardOnly(true);
+        if (!query.exec(QString("SELECT %1 FROM %2 ORDER BY rowid").arg(columns.join(", "), table))) {
+            return fail(query.lastError().text());
+        }
+
+        while (query.next()) {
+            for (int i = 0; i < columns.size(); ++i) {
+                if (i > 0) buffer += ',';
+                CsvReader::appendField(buffer, query.value(i));
+            }
+            buffer += '\n';
+            ++done;
+
+            if (buffer.size() >= flushThreshold) {
+                if (file.write(buffer) != buffer.size()) return fail(file.errorString());
+                buffer.clear();
+                if (progress) progress(done, total);
+            }
+        }
+
+        if (file.write(buffer) != buffer.size()) {
+            return fail(file.errorString());
+        }
+    }
+    if (!db.commit()) {
+        return fail(db.lastError().text());
+    }
+
+    for (const std::unique_ptr<QSaveFile>& file : files) {
+        if (!file->commit()) {
+            qWarning() << "exportToCsv failed:" << file->errorString();
+            return false;
+        }
+    }
+    if (progress) progress(total, total);
+    reportTransfer("exportToCsv", done, timer, stats);
+    return true;
+}
+
+bool Database::importFromCsv(const QString& directory, const ProgressCallback& progress,
+                             TransferStats* stats, int batchSize) {
+    QElapsedTimer timer;
+    timer.start();
+
+    // Parents first, in the same order the export writes them
+    QDir dir(directory);
+    qint64 total = 0;
+    for (const QString& table : dataTables()) {
+        total += QFileInfo(dir.filePath(table + ".csv")).size();
+    }
+    qint64 done = 0;
+
+    BatchInserter inserter(connection(), batchSize);
+
+    for (const QString& table : dataTables()) {
+        QFile file(dir.filePath(table + ".csv"));
+        if (!file.exists()) continue;
+        if (!file.open(QIODevice::ReadOnly)) {
+            qWarning() << "importFromCsv failed:" << file.errorString();
+            return false;
+        }
+
+        CsvReader reader(&file);
+        QVariantList header;
+        if (!reader.readRecord(header)) {
+            done += file.size();
+            continue;
+        }
+        QStringList columns;
+        for (const QVariant& column : header) {
+            columns << column.toString();
+        }
+
+        QVariantList record;
+        qint64 recordNumber = 1;
+        while (reader.readRecord(record)) {
+            ++recordNumber;
+            if (record.size() != columns.size()) {
+                qWarning() << "importFromCsv failed:" << table + ".csv record" << recordNumber
+                           << "has" << record.size() << "fields, expected" << columns.size();
+                return false;
+            }
+            if (!inserter.insert(table, columns, record)) {
+                qWarning() << "importFromCsv failed:" << table + ".csv record" << recordNumber
+                           << ":" << inserter.errorString();
+                return false;
+            }
+            if (progress && recordNumber % 1000 == 0) progress(done + reader.bytesRead(), total);
+        }
+        done += file.size();
+    }
+
+    if (!inserter.commit()) {
+        qWarning() << "importFromCsv failed:" << inserter.errorString();
+        return false;
+    }
+    if (progress) progress(total, total);
+    reportTransfer("importFromCsv", inserter.rows(), timer, stats);
+    return true;
+}
@@ -0,0 +1,101 @@
+#include "databaseworker.h"
+#include <QDebug>
+
+namespace {
+    const char* const kConnectionName = "worker";
+}
+
+DatabaseWorker::DatabaseWorker(QObject* parent)
+    : QObject(parent), m_context(new QObject) {
+    m_context->moveToThread(&m_thread);
+    connect(&m_thread, &QThread::finished, m_context, &QObject::deleteLater);
+    m_thread.setObjectName("DatabaseWorker");
+    m_thread.start();
+
+    QMetaObject::invokeMethod(m_context, []() {
+        if (!Database::openConnection(kConnectionName)) {
+            qCritical() << "Database worker could not open its connection";
+        }
+    });
+}
+
+DatabaseWorker::~DatabaseWorker() {
+    // Queued after any pending jobs, so they finish on the old connection first
+    QMetaObject::invokeMethod(m_context, []() {
+        Database::closeConnection(kConnectionName);
+    }, Qt::BlockingQueuedConnection);
+    m_thread.quit();
+    m_thread.wait();
+}
+
+QFuture<QVector<Task>> DatabaseWorker::getAllTasks() {
+    return run<QVector<Task>>([](QFutureInterface<QVector<Task>>&) {
+        return Database::getAllTasks();
+    });
+}
+
+QFuture<QVector<Task>> DatabaseWorker::getTasksInRange(const QDateTime& from, const QDateTime& to, bool includeCompleted) {
+    return run<QVector<Task>>([from, to, includeCompleted](QFutureInterface<QVector<Task>>&) {
+        return Database::getTasksInRange(from, to, includeCompleted);
+    });
+}
+
+QFuture<bool> DatabaseWorker::backupDatabase(const QString& backupPath) {
+    return run<bool>([backupPath](QFutureInterface<bool>& promise) {
+        return Database::backupDatabase(backupPath, progressReporter(promise));
+    });
+}
+
+QFuture<bool> DatabaseWorker::restoreDatabase(const QString& backupPath) {
+    return run<bool>([backupPath](QFutureInterface<bool>& promise) {
+        return Database::restoreDatabase(backupPath, progressReporter(promise));
+    });
+}
+
+QFuture<bool> DatabaseWorker::exportToSQL(const QString& filePath) {
+    return run<bool>([filePath](QFutureInterface<bool>& promise) {
+        return Database::exportToSQL(filePath, progressReporter(promise));
+    });
+}
+
+QFuture<bool> DatabaseWorker::importFromSQL(const QString& filePath) {
+    return run<bool>([filePath](QFutureInterface<bool>& promise) {
+        return Database::importFromSQL(filePath, progressReporter(promise));
+    });
+}
+
+QFuture<bool> DatabaseWorker::exportSnapshot(const QString& filePath) {
+    return run<bool>([filePath](QFutureInterface<bool>& promise) {
+        return Database::exportSnapshot(filePath, progressReporter(promise));
+    });
+}
+
+QFuture<bool> DatabaseWorker::importSnapshot(const QString& filePath) {
+    return run<bool>([filePath](QFutureInterface<bool>& promise) {
+        return Database::importSnapshot(filePath, progressReporter(promise));
+    });
+}
+
+QFuture<bool> DatabaseWorker::exportToJsonLines(const QString& filePath, StatsPtr stats) {
+    return run<bool>([filePath, stats](QFutureInterface<bool>& promise) {
+        return Database::exportToJsonLines(filePath, progressReporter(promise), stats.get());
+    });
+}
+
+QFuture<bool> DatabaseWorker::importFromJsonLines(const QString& filePath, StatsPtr stats) {
+    return run<bool>([filePath, stats](QFutureInterface<bool>& promise) {
+        return Database::importFromJsonLines(filePath, progressReporter(promise), stats.get());
+    });
+}
+
+QFuture<bool> DatabaseWorker::exportToCsv(const QString& directory, StatsPtr stats) {
+    return run<bool>([directory, stats](QFutureInterface<bool>& promise) {
+        return Database::exportToCsv(directory, progressReporter(promise), stats.get());
+    });
+}
+
+QFuture<bool> DatabaseWorker::importFromCsv(const QString& directory, StatsPtr stats) {
+    return run<bool>([directory, stats](QFutureInterface<bool>& promise) {
+        return Database::importFromCsv(directory, progressReporter(promise), stats.get());
+    });
+}
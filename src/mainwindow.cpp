@@ -28,6 +28,7 @@
 #include <QSpinBox>
 #include <QCheckBox>
 #include <QMap>
+#include <QSet>
 #include "calendardelegate.h"
 #include <QListWidget>
 #include <QListWidgetItem>
@@ -38,13 +39,32 @@
 #include <QMenu>
 #include <QDir>
 #include <QFileDialog>
-
-// Priority names for display
-const QStringList priorityNames = {"None", "Urgent", "Important", "Urgent & Important"};
+#include <QFutureWatcher>
+#include <QProgressDialog>
+#include "databaseworker.h"
+#include "taskpagemodel.h"
+#include "changenotifier.h"
+#include "refreshscheduler.h"
+#include "taskfilterproxymodel.h"
+
+namespace {
+    // Pause in typing before the task list search is applied
+    const int kSearchDebounceMs = 200;
+
+    // Calendar cell format for days with open tasks
+    QTextCharFormat taskDayFormat() {
+        QTextCharFormat format;
+        format.setBackground(QBrush(QColor(255, 220, 200)));
+        format.setFontWeight(QFont::Bold);
+        return format;
+    }
+}
 
 MainWindow::MainWindow(QWidget* parent) : QMainWindow(parent) {
     setupDatabase();
+    dbWorker = new DatabaseWorker(this);
     setupUI();
+    setupRefreshScheduler();
     setupConnections();
     refreshAllViews();
     refreshTemplateCombo();
@@ -68,12 +88,28 @@ void MainWindow::setupUI() {
     restoreAction = new QAction("Restore Database", this);
     exportAction = new QAction("Export to SQL", this);
     importAction = new QAction("Import from SQL", this);
+    exportSnapshotAction = new QAction("Export Snapshot", this);
+    importSnapshotAction = new QAction("Import Snapshot", this);
+    exportJsonAction = new QAction("Export to JSON Lines", this);
+    importJsonAction = new QAction("Import from JSON Lines", this);
+    exportCsvAction = new QAction("Export to CSV", this);
+    importCsvAction = new QAction("Import from CSV", this);
+    archiveAction = new QAction("View Archive", this);
     
     fileMenu->addAction(backupAction);
     fileMenu->addAction(restoreAction);
     fileMenu->addSeparator();
     fileMenu->addAction(exportAction);
     fileMenu->addAction(importAction);
+    fileMenu->addAction(exportSnapshotAction);
+    fileMenu->addAction(importSnapshotAction);
+    fileMenu->addSeparator();
+    fileMenu->addAction(exportJsonAction);
+    fileMenu->addAction(importJsonAction);
+    fileMenu->addAction(exportCsvAction);
+    fileMenu->addAction(importCsvAction);
+    fileMenu->addSeparator();
+    fileMenu->addAction(archiveAction);
 
     qApp->setStyleSheet(
         "QDialog {"
@@ -139,12 +175,11 @@ void MainWindow::setupUI() {
     
     // Task table view
     taskView = new QTableView(taskListPanel);
-    model = new QStandardItemModel(0, 5, this); // Cols: Completed, Title, Description, Deadline, Priority
-    model->setHorizontalHeaderLabels({"", "Title", "Description", "Deadline", "Priority"});
+    model = new TaskPageModel({TaskTableModel::Column::Completed, TaskTableModel::Column::Title,
+                               TaskTableModel::Column::Description, TaskTableModel::Column::Deadline,
+                               TaskTableModel::Column::Priority}, this);
     
-    proxyModel = new QSortFilterProxyModel(this);
-    proxyModel->setSourceModel(model);
-    proxyModel->setFilterKeyColumn(-1); // Filter on all columns
+    proxyModel = new TaskFilterProxyModel(model, this);
     taskView->setModel(proxyModel);
     
     // Customize table appearance
@@ -202,8 +237,8 @@ void MainWindow::setupUI() {
     taskListLayout->setContentsMargins(0, 0, 0, 0);
 
     calendarTaskView = new QTableView(taskListPanel);
-    calendarModel = new QStandardItemModel(0, 4, this);
-    calendarModel->setHorizontalHeaderLabels({"Title", "Priority", "Status", "Time"});
+    calendarModel = new TaskTableModel({TaskTableModel::Column::Title, TaskTableModel::Column::Priority,
+                                        TaskTableModel::Column::Status, TaskTableModel::Column::Time}, this);
     calendarTaskView->setModel(calendarModel);
 
     // Configure task list view
@@ -443,7 +478,10 @@ void MainWindow::setupConnections() {
         showCompletedCheckbox->setChecked(false);
         filterTasks();
     });
-    connect(searchBox, &QLineEdit::textChanged, this, &MainWindow::filterTasks);
+    connect(searchBox, &QLineEdit::textChanged, this, [this]() {
+        // One filter pass once typing pauses, not one per keystroke
+        refreshScheduler->markDirty(RefreshScheduler::TaskList, kSearchDebounceMs);
+    });
     connect(priorityFilter, QOverload<int>::of(&QComboBox::currentIndexChanged), 
             this, &MainWindow::updatePriorityFilter);
     connect(showCompletedCheckbox, &QCheckBox::stateChanged, this, &MainWindow::filterTasks);
@@ -459,12 +497,6 @@ void MainWindow::setupConnections() {
             this, &MainWindow::loadTODOItemsForList);
     connect(addTodoItemButton, &QPushButton::clicked,
             this, &MainWindow::addTODOItem);
-    connect(mainTabs, &QTabWidget::currentChanged, this, [this](int index) {
-        if (mainTabs->tabText(index) == "Today") {
-            refreshTodayTasks();
-            refreshTodayTodoItems();
-        }
-    });
     connect(deleteTodoListButton, &QPushButton::clicked,
         this, &MainWindow::deleteTODOList);
     connect(deleteTodoItemButton, &QPushButton::clicked,
@@ -490,14 +522,105 @@ void MainWindow::setupConnections() {
             this, &MainWindow::onTodayTodoItemDoubleClicked);
     connect(calendarTaskView->selectionModel(), &QItemSelectionModel::currentChanged,
             this, &MainWindow::updateCalendarTaskDetails);
+
+    // Each view follows the data it shows. Queued, so slots run once the
+    // write has returned and the task cache has caught up.
+    ChangeNotifier* notifier = ChangeNotifier::instance();
+    connect(notifier, &ChangeNotifier::taskInserted, this, [this](const Task& task) {
+        applyTaskChange(Task(), task);
+    }, Qt::QueuedConnection);
+    connect(notifier, &ChangeNotifier::taskUpdated, this, [this](const Task& before, const Task& after) {
+        applyTaskChange(before, after);
+    }, Qt::QueuedConnection);
+    connect(notifier, &ChangeNotifier::taskDeleted, this, [this](const Task& task) {
+        applyTaskChange(task, Task());
+    }, Qt::QueuedConnection);
+    connect(notifier, &ChangeNotifier::tasksReset, this, &MainWindow::reloadTasks, Qt::QueuedConnection);
+
+    // Plans tab
+    auto reloadPlanLists = [this]() {
+        refreshScheduler->markDirty(RefreshScheduler::PlanLists);
+    };
+    auto reloadPlanItems = [this]() {
+        refreshScheduler->markDirty(RefreshScheduler::PlanItems);
+    };
+    connect(notifier, &ChangeNotifier::todoListInserted, this, reloadPlanLists, Qt::QueuedConnection);
+    connect(notifier, &ChangeNotifier::todoListUpdated, this, reloadPlanLists, Qt::QueuedConnection);
+    connect(notifier, &ChangeNotifier::todoListDeleted, this, reloadPlanLists, Qt::QueuedConnection);
+    connect(notifier, &ChangeNotifier::todoItemInserted, this, reloadPlanItems, Qt::QueuedConnection);
+    connect(notifier, &ChangeNotifier::todoItemUpdated, this, reloadPlanItems, Qt::QueuedConnection);
+    connect(notifier, &ChangeNotifier::todoItemDeleted, this, reloadPlanItems, Qt::QueuedConnection);
+
+    // Today tab shows the items of every plan due today
+    for (auto signal : {&ChangeNotifier::todoListInserted, &ChangeNotifier::todoListDeleted,
+                        &ChangeNotifier::todoItemInserted, &ChangeNotifier::todoItemUpdated,
+                        &ChangeNotifier::todoItemDeleted}) {
+        connect(notifier, signal, this, [this]() {
+            refreshScheduler->markDirty(RefreshScheduler::TodayPlan);
+        }, Qt::QueuedConnection);
+    }
+
+    // Template picker
+    for (auto signal : {&ChangeNotifier::templateInserted, &ChangeNotifier::templateDeleted}) {
+        connect(notifier, signal, this, [this]() {
+            refreshScheduler->markDirty(RefreshScheduler::Templates);
+        }, Qt::QueuedConnection);
+    }
+
+    connect(notifier, &ChangeNotifier::dataReset, this, &MainWindow::reloadAll, Qt::QueuedConnection);
+
     taskView->installEventFilter(this);
     todayTaskView->installEventFilter(this);
     todayTodoView->installEventFilter(this);
     todoItemView->installEventFilter(this);
     connect(backupAction, &QAction::triggered, this, &MainWindow::backupDatabase);
+    connect(archiveAction, &QAction::triggered, this, &MainWindow::showArchive);
     connect(restoreAction, &QAction::triggered, this, &MainWindow::restoreDatabase);
     connect(exportAction, &QAction::triggered, this, &MainWindow::exportDatabase);
     connect(importAction, &QAction::triggered, this, &MainWindow::importDatabase);
+    connect(exportSnapshotAction, &QAction::triggered, this, &MainWindow::exportSnapshot);
+    connect(importSnapshotAction, &QAction::triggered, this, &MainWindow::importSnapshot);
+    connect(exportJsonAction, &QAction::triggered, this, &MainWindow::exportJsonLines);
+    connect(importJsonAction, &QAction::triggered, this, &MainWindow::importJsonLines);
+    connect(exportCsvAction, &QAction::triggered, this, &MainWindow::exportCsv);
+    connect(importCsvAction, &QAction::triggered, this, &MainWindow::importCsv);
+}
+
+void MainWindow::setupRefreshScheduler() {
+    refreshScheduler = new RefreshScheduler(mainTabs, this);
+
+    auto page = [this](const QString& title) -> QWidget* {
+        for (int i = 0; i < mainTabs->count(); ++i) {
+            if (mainTabs->tabText(i) == title) return mainTabs->widget(i);
+        }
+        return nullptr;
+    };
+
+    refreshScheduler->addView(RefreshScheduler::TaskList, page("Tasks"), [this]() {
+        refreshTaskList();
+    });
+    refreshScheduler->addView(RefreshScheduler::Calendar, page("Calendar"), [this]() {
+        highlightTaskDates();
+        updateCalendarTasks(calendarWidget->selectedDate());
+    });
+    // Today reloads on every visit, in case the day has rolled over
+    refreshScheduler->addView(RefreshScheduler::TodayTasks, todayTab, [this]() {
+        refreshTodayTasks();
+    }, true);
+    refreshScheduler->addView(RefreshScheduler::TodayPlan, todayTab, [this]() {
+        refreshTodayTodoItems();
+    }, true);
+    // Lists before items: reloading the lists drops the selected one
+    refreshScheduler->addView(RefreshScheduler::PlanLists, page("Plan"), [this]() {
+        loadTODOListsForDate(todoDateEdit->date());
+        todoItemModel->removeRows(0, todoItemModel->rowCount());
+    });
+    refreshScheduler->addView(RefreshScheduler::PlanItems, page("Plan"), [this]() {
+        loadTODOItemsForList(todoListView->currentIndex());
+    });
+    refreshScheduler->addView(RefreshScheduler::Templates, page("Plan"), [this]() {
+        refreshTemplateCombo();
+    });
 }
 
 void MainWindow::applyTableStyling() {
@@ -538,64 +661,15 @@ void MainWindow::applyTableStyling() {
 }
 
 void MainWindow::refreshTaskList() {
-    model->removeRows(0, model->rowCount());
-    QVector<Task> tasks = Database::getAllTasks();
-
-    QDateTime currentDateTime = QDateTime::currentDateTime();
-    bool showCompleted = showCompletedCheckbox->isChecked();
-
-    for (const Task& task : tasks) {
-        // Skip completed tasks if checkbox isn't checked
-        if (!showCompleted && task.isCompleted) continue;
-
-        QList<QStandardItem*> rowItems;
-        
-        // Completion checkbox
-        QStandardItem* completedItem = new QStandardItem;
-        completedItem->setCheckable(true);
-        completedItem->setCheckState(task.isCompleted ? Qt::Checked : Qt::Unchecked);
-        completedItem->setTextAlignment(Qt::AlignCenter);
-        rowItems << completedItem;
-        
-        // Title
-        QStandardItem* titleItem = new QStandardItem(task.title);
-        if (!task.isCompleted && task.deadline < currentDateTime) {
-            titleItem->setForeground(QBrush(Qt::red));
-        }
-        if (task.isCompleted) {
-            QFont font = titleItem->font();
-            font.setStrikeOut(true);
-            titleItem->setFont(font);
-            titleItem->setForeground(QBrush(Qt::gray));
-        }
-        rowItems << titleItem;
-        
-        // Description (shortened)
-        QString shortDesc = task.description.length() > 50 
-                          ? task.description.left(47) + "..." 
-                          : task.description;
-        rowItems << new QStandardItem(shortDesc);
-        
-        // Deadline
-        rowItems << new QStandardItem(task.deadline.toString("dd/MM/yyyy hh:mm"));
-        
-        // Priority
-        int priority = task.priority;
-        QStandardItem* priorityItem = new QStandardItem(priorityNames.value(priority, "None"));
-        switch (priority) {
-            case 1: priorityItem->setForeground(QBrush(Qt::red)); break;
-            case 2: priorityItem->setForeground(QBrush(QColor(255, 165, 0))); break; // Orange
-            case 3: priorityItem->setForeground(QBrush(Qt::darkRed)); break;
-        }
-        rowItems << priorityItem;
-        
-        // Store ID in first item
-        rowItems.first()->setData(task.id);
-        
-        model->appendRow(rowItems);
-    }
-    
-    statusBar()->showMessage(QString("Showing %1 tasks").arg(tasks.size()));
+    // Narrowing the loaded rows is masked in memory; anything else runs in
+    // SQL and the model pages rows in as the view scrolls
+    Database::TaskFilter filter;
+    filter.text = searchBox->text().trimmed();
+    filter.priority = priorityFilter->currentIndex() - 1;
+    filter.includeCompleted = showCompletedCheckbox->isChecked();
+    proxyModel->setFilter(filter);
+
+    statusBar()->showMessage(QString("Showing %1 tasks").arg(proxyModel->matchCount()));
 }
 
 void MainWindow::addTask() {
@@ -647,17 +721,9 @@ void MainWindow::createTaskDialog(bool isEditing) {
     if (isEditing) {
         QModelIndex proxyIndex = taskView->currentIndex();
         QModelIndex sourceIndex = proxyModel->mapToSource(proxyIndex);
-        QStandardItem* idItem = model->item(sourceIndex.row(), 0);
-        int taskId = idItem->data().toInt();
+        int taskId = model->taskAt(sourceIndex.row()).id;
         
-        Task task;
-        QVector<Task> allTasks = Database::getAllTasks();
-        for (const Task& t : allTasks) {
-            if (t.id == taskId) {
-                task = t;
-                break;
-            }
-        }
+        Task task = taskStore.task(taskId);
         
         titleEdit->setText(task.title);
         descriptionEdit->setText(task.description);
@@ -673,8 +739,7 @@ void MainWindow::createTaskDialog(bool isEditing) {
         if (isEditing) {
             QModelIndex proxyIndex = taskView->currentIndex();
             QModelIndex sourceIndex = proxyModel->mapToSource(proxyIndex);
-            QStandardItem* idItem = model->item(sourceIndex.row(), 0);
-            task.id = idItem->data().toInt();
+            task.id = model->taskAt(sourceIndex.row()).id;
         }
         
         task.title = titleEdit->text();
@@ -682,9 +747,8 @@ void MainWindow::createTaskDialog(bool isEditing) {
         task.deadline = deadlineEdit->dateTime();
         task.priority = priorityCombo->currentIndex();
         
-        bool success = isEditing ? Database::updateTask(task) : Database::createTask(task);
+        bool success = isEditing ? taskStore.updateTask(task) : taskStore.createTask(task);
         if (success) {
-            refreshAllViews();
             statusBar()->showMessage(isEditing ? "Task updated" : "Task added", 3000);
         } else {
             QMessageBox::warning(this, "Error", "Failed to save task.");
@@ -700,15 +764,13 @@ void MainWindow::deleteTask() {
     }
     
     QModelIndex sourceIndex = proxyModel->mapToSource(currentIndex);
-    QStandardItem* idItem = model->item(sourceIndex.row(), 0);
-    int taskId = idItem->data().toInt();
+    int taskId = model->taskAt(sourceIndex.row()).id;
     
     int ret = QMessageBox::question(this, "Delete Task", 
                                   "Are you sure you want to delete this task?",
                                   QMessageBox::Yes | QMessageBox::No);
     if (ret == QMessageBox::Yes) {
-        if (Database::deleteTask(taskId)) {
-            refreshAllViews();
+        if (taskStore.deleteTask(taskId)) {
             statusBar()->showMessage("Task deleted", 3000);
         } else {
             QMessageBox::warning(this, "Error", "Failed to delete task.");
@@ -724,22 +786,14 @@ void MainWindow::toggleTaskCompletion() {
     }
     
     QModelIndex sourceIndex = proxyModel->mapToSource(currentIndex);
-    QStandardItem* idItem = model->item(sourceIndex.row(), 0);
-    int taskId = idItem->data().toInt();
-    
-    Task task;
-    QVector<Task> allTasks = Database::getAllTasks();
-    for (const Task& t : allTasks) {
-        if (t.id == taskId) {
-            task = t;
-            break;
-        }
-    }
+    int taskId = model->taskAt(sourceIndex.row()).id;
+    
+    Task task = taskStore.task(taskId);
+    if (task.id == -1) return;
     
     task.isCompleted = !task.isCompleted;
     
-    if (Database::updateTask(task)) {
-        refreshAllViews();
+    if (taskStore.updateTask(task)) {
         statusBar()->showMessage(task.isCompleted ? "Task marked complete" : "Task marked incomplete", 3000);
     } else {
         QMessageBox::warning(this, "Error", "Failed to update task status.");
@@ -754,17 +808,9 @@ void MainWindow::showTaskDetails(const QModelIndex &index) {
     }
     
     QModelIndex sourceIndex = proxyModel->mapToSource(index);
-    QStandardItem* idItem = model->item(sourceIndex.row(), 0);
-    currentTaskId = idItem->data().toInt();
-    
-    Task task;
-    QVector<Task> allTasks = Database::getAllTasks();
-    for (const Task& t : allTasks) {
-        if (t.id == currentTaskId) {
-            task = t;
-            break;
-        }
-    }
+    currentTaskId = model->taskAt(sourceIndex.row()).id;
+    
+    Task task = taskStore.task(currentTaskId);
     
     QString details = QString("<h2>%1</h2>"
                             "<p><b>Status:</b> %2</p>"
@@ -781,127 +827,48 @@ void MainWindow::showTaskDetails(const QModelIndex &index) {
 }
 
 void MainWindow::filterTasks() {
-    QString searchText = searchBox->text().toLower();   
-    proxyModel->setFilterRegExp(QRegExp(searchText, Qt::CaseInsensitive, QRegExp::FixedString));
-    refreshAllViews();
+    // Only the task list is filtered
+    refreshScheduler->markDirty(RefreshScheduler::TaskList);
 }
 
 void MainWindow::updatePriorityFilter(int index) {
-    if (index == 0) { // "All Priorities"
-        proxyModel->setFilterRegExp("");
-    } else {
-        proxyModel->setFilterRegExp(QRegExp(priorityNames.at(index-1), 
-                                          Qt::CaseInsensitive, 
-                                          QRegExp::FixedString));
-    }
-    refreshAllViews();
-}
-
-QVector<Task> MainWindow::getAllFilteredTasks() {
-    QVector<Task> allTasks = Database::getAllTasks();
-    QVector<Task> filteredTasks;
-    
-    int priorityFilterIndex = priorityFilter->currentIndex();
-    QString searchText = searchBox->text().toLower();
-    
-    for (const Task& task : allTasks) {
-        // Priority filter
-        if (priorityFilterIndex > 0 && task.priority != priorityFilterIndex - 1) {
-            continue;
-        }
-        
-        // Search text
-        if (!searchText.isEmpty()) {
-            bool textMatch = task.title.contains(searchText, Qt::CaseInsensitive) ||
-                           task.description.contains(searchText, Qt::CaseInsensitive);
-            if (!textMatch) continue;
-        }
-        
-        filteredTasks.append(task);
-    }
-    
-    return filteredTasks;
+    Q_UNUSED(index);
+    // The calendar shows every priority, so only the list depends on it
+    refreshScheduler->markDirty(RefreshScheduler::TaskList);
 }
 
 void MainWindow::highlightTaskDates() {
     // Clear previous formatting
     calendarWidget->setDateTextFormat(QDate(), QTextCharFormat());
     
-    // Get all tasks
-    QVector<Task> tasks = Database::getAllTasks();
-    int currentYear = calendarWidget->yearShown();
-    int currentMonth = calendarWidget->monthShown();   
+    // Per-day counts and first titles of open tasks in the shown month
+    QMap<QDate, TaskDaySummary> tasksByDate =
+        Database::getMonthSummary(calendarWidget->yearShown(), calendarWidget->monthShown());
 
-    QTextCharFormat highlightFormat;
-    highlightFormat.setBackground(QBrush(QColor(255, 220, 200)));
-    highlightFormat.setFontWeight(QFont::Bold);
-    
-    // Prepare tasks by date
-    QMap<QDate, QStringList> tasksByDate;
-    
     // Highlight dates with tasks
-    for (const Task& task : tasks) {
-        QDate taskDate = task.deadline.date();
-        if (taskDate.year() != currentYear || taskDate.month() != currentMonth) {
-            continue;
-        }
-        
-        // Don't highlight completed tasks
-        if (task.isCompleted) continue;
-        
-        // Add task title to date
-        if (!tasksByDate.contains(taskDate)) {
-            tasksByDate[taskDate] = QStringList();
-        }
-        tasksByDate[taskDate].append(task.title);
-        
-        calendarWidget->setDateTextFormat(taskDate, highlightFormat);
+    const QTextCharFormat highlightFormat = taskDayFormat();
+    for (auto it = tasksByDate.constBegin(); it != tasksByDate.constEnd(); ++it) {
+        calendarWidget->setDateTextFormat(it.key(), highlightFormat);
     }
     
-    // Access the calendar's internal view and set delegate
+    // Access the calendar's internal view and set delegate, reusing the
+    // one installed on a previous month
     QTableView* calendarView = calendarWidget->findChild<QTableView*>();
     if (calendarView) {
-        calendarView->setItemDelegate(new CalendarDelegate(tasksByDate, this));
+        CalendarDelegate* delegate = dynamic_cast<CalendarDelegate*>(calendarView->itemDelegate());
+        if (delegate) {
+            delegate->setTasks(tasksByDate);
+            calendarView->viewport()->update();
+        } else {
+            calendarView->setItemDelegate(new CalendarDelegate(tasksByDate, this));
+        }
     }
 }
 
 void MainWindow::updateCalendarTasks(const QDate &date) {
-    calendarModel->removeRows(0, calendarModel->rowCount());
-    
-    QVector<Task> tasks = Database::getAllTasks();
     QDateTime startOfDay(date, QTime(0, 0));
-    QDateTime endOfDay(date, QTime(23, 59, 59));
-    
-    for (const Task& task : tasks) {
-        // Skip tasks not on this date
-        if (task.deadline < startOfDay || task.deadline > endOfDay) continue;
-        
-        QList<QStandardItem*> rowItems;
-        rowItems << new QStandardItem(task.title);
-        
-        // Priority
-        QStandardItem* priorityItem = new QStandardItem(priorityNames.value(task.priority, "None"));
-        switch (task.priority) {
-            case 1: priorityItem->setForeground(QBrush(Qt::red)); break;
-            case 2: priorityItem->setForeground(QBrush(QColor(255, 165, 0))); break;
-            case 3: priorityItem->setForeground(QBrush(Qt::darkRed)); break;
-        }
-        rowItems << priorityItem;
-        
-        // Status
-        QString status = task.isCompleted ? "Completed" : "Pending";
-        if (!task.isCompleted && task.deadline < QDateTime::currentDateTime()) {
-            status = "Overdue";
-        }
-        QStandardItem* statusItem = new QStandardItem(status);
-        if (status == "Overdue") statusItem->setForeground(QBrush(Qt::red));
-        rowItems << statusItem;
-        
-        // Time
-        rowItems << new QStandardItem(task.deadline.time().toString("hh:mm"));
-        
-        calendarModel->appendRow(rowItems);
-    }
+    calendarModel->setTasks(taskStore.tasksInRange(startOfDay, startOfDay.addDays(1)),
+                            Database::getArchivedTasksInRange(startOfDay, startOfDay.addDays(1)));
     
     // Clear details when date changes
     calendarDetailsView->clear();
@@ -913,18 +880,75 @@ void MainWindow::updateCalendarTasks(const QDate &date) {
 }
 
 void MainWindow::refreshAllViews() {
-    refreshTaskList();
-    highlightTaskDates();
-    updateCalendarTasks(calendarWidget->selectedDate());
+    refreshScheduler->markDirty(RefreshScheduler::TaskList | RefreshScheduler::Calendar);
+}
+
+void MainWindow::reloadTasks() {
+    proxyModel->markStale();
+    refreshScheduler->markDirty(RefreshScheduler::TaskList | RefreshScheduler::Calendar |
+                                RefreshScheduler::TodayTasks);
+}
+
+void MainWindow::reloadAll() {
+    reloadTasks();
+    refreshScheduler->markDirty(RefreshScheduler::TodayPlan | RefreshScheduler::PlanLists |
+                                RefreshScheduler::Templates);
+}
+
+void MainWindow::applyTaskChange(const Task& before, const Task& after) {
+    // Task list; a search filter still needs the FTS index to decide
+    if (!model->applyChange(before, after)) {
+        proxyModel->markStale();
+        refreshScheduler->markDirty(RefreshScheduler::TaskList);
+    }
+
+    // Today: open tasks due today
+    const QDate today = QDate::currentDate();
+    if (after.id != -1) {
+        todayTaskModel->upsertTask(after, after.deadline.date() == today && !after.isCompleted);
+    } else {
+        todayTaskModel->removeTask(before.id);
+    }
+
+    // Calendar day list for the selected date
+    const QDate selected = calendarWidget->selectedDate();
+    if (after.id != -1) {
+        calendarModel->upsertTask(after, after.deadline.date() == selected);
+    } else {
+        calendarModel->removeTask(before.id);
+    }
+
+    // Calendar cells of the days the task left and joined
+    QSet<QDate> days;
+    if (before.id != -1) days.insert(before.deadline.date());
+    if (after.id != -1) days.insert(after.deadline.date());
+    for (const QDate& day : days) {
+        refreshCalendarDay(day);
+    }
+}
+
+void MainWindow::refreshCalendarDay(const QDate& date) {
+    if (date.year() != calendarWidget->yearShown() || date.month() != calendarWidget->monthShown()) {
+        return; // highlightTaskDates() covers it when its month is shown
+    }
+
+    const TaskDaySummary day = Database::getDaySummaries(date, date.addDays(1)).value(date);
+    calendarWidget->setDateTextFormat(date, day.openCount > 0 ? taskDayFormat() : QTextCharFormat());
+
+    QTableView* calendarView = calendarWidget->findChild<QTableView*>();
+    if (calendarView) {
+        if (CalendarDelegate* delegate = dynamic_cast<CalendarDelegate*>(calendarView->itemDelegate())) {
+            delegate->setDay(date, day);
+            calendarView->viewport()->update();
+        }
+    }
 }
 
 void MainWindow::loadTODOListsForDate(const QDate &date) {
     todoListModel->clear();
     
-    QVector<TODOList> lists = Database::getAllTODOLists();
+    QVector<TODOList> lists = Database::getTODOListsForDate(date);
     for (const TODOList& list : lists) {
-        if (list.date != date) continue;
-        
         QStandardItem* item = new QStandardItem(list.name);
         item->setData(list.id);
         todoListModel->appendRow(item);
@@ -943,9 +967,7 @@ void MainWindow::createTODOList() {
     newList.name = name;
     newList.date = todoDateEdit->date();
     
-    if (Database::createTODOList(newList)) {
-        loadTODOListsForDate(newList.date);
-    }
+    Database::createTODOList(newList);
 }
 
 void MainWindow::loadTODOItemsForList(const QModelIndex &index) {
@@ -1073,13 +1095,7 @@ void MainWindow::createTodoItemDialog(int listId, int itemId) {
     // If editing, populate with existing data
     TODOItem item;
     if (itemId >= 0) {
-        QVector<TODOItem> allItems = Database::getItemsForList(listId);
-        for (const TODOItem& i : allItems) {
-            if (i.id == itemId) {
-                item = i;
-                break;
-            }
-        }
+        item = Database::getTODOItemById(itemId);
         
         titleEdit->setText(item.title);
         descriptionEdit->setText(item.description);
@@ -1106,9 +1122,7 @@ void MainWindow::createTodoItemDialog(int listId, int itemId) {
             success = Database::createTODOItem(newItem);
         }
         
-        if (success) {
-            loadTODOItemsForList(todoListView->currentIndex());
-        } else {
+        if (!success) {
             QMessageBox::warning(this, "Error", "Failed to save item.");
         }
     }
@@ -1138,8 +1152,8 @@ void MainWindow::setupTodayTab() {
     QVBoxLayout* taskLayout = new QVBoxLayout(taskGroup);
     
     todayTaskView = new QTableView(taskGroup);
-    todayTaskModel = new QStandardItemModel(0, 4, this);
-    todayTaskModel->setHorizontalHeaderLabels({"", "Title", "Time", "Priority"});
+    todayTaskModel = new TaskTableModel({TaskTableModel::Column::Completed, TaskTableModel::Column::Title,
+                                         TaskTableModel::Column::Time, TaskTableModel::Column::Priority}, this);
     todayTaskView->setModel(todayTaskModel);
     todayTaskView->setSelectionBehavior(QAbstractItemView::SelectRows);
     
@@ -1211,76 +1225,13 @@ void MainWindow::setupTodayTab() {
 }
 
 void MainWindow::refreshTodayTasks() {
-    todayTaskModel->removeRows(0, todayTaskModel->rowCount());
-    
-    QDate today = QDate::currentDate();
-    QVector<Task> tasks = getTasksForDate(today);
-    
-    for (const Task& task : tasks) {
-        QList<QStandardItem*> rowItems;
-        
-        // Completion checkbox
-        QStandardItem* completedItem = new QStandardItem;
-        completedItem->setCheckable(true);
-        completedItem->setCheckState(task.isCompleted ? Qt::Checked : Qt::Unchecked);
-        completedItem->setData(task.id);
-        rowItems << completedItem;
-        
-        // Title
-        QStandardItem* titleItem = new QStandardItem(task.title);
-        if (task.isCompleted) {
-            QFont font = titleItem->font();
-            font.setStrikeOut(true);
-            titleItem->setFont(font);
-            titleItem->setForeground(QBrush(Qt::gray));
-        }
-        rowItems << titleItem;
-        
-        // Description
-        /*
-        QStandardItem* descItem = new QStandardItem(task.description);
-        if (task.isCompleted) {
-            QFont font = descItem->font();
-            font.setStrikeOut(true);
-            descItem->setFont(font);
-            descItem->setForeground(QBrush(Qt::gray));
-        }
-        rowItems << descItem;
-        //*/
-        
-        // Deadline time
-        rowItems << new QStandardItem(task.deadline.time().toString("hh:mm"));
-        
-        // Priority
-        QStandardItem* priorityItem = new QStandardItem(priorityNames.value(task.priority, "None"));
-        switch (task.priority) {
-            case 1: priorityItem->setForeground(QBrush(Qt::red)); break;
-            case 2: priorityItem->setForeground(QBrush(QColor(255, 165, 0))); break;
-            case 3: priorityItem->setForeground(QBrush(Qt::darkRed)); break;
-        }
-        rowItems << priorityItem;
-        
-        todayTaskModel->appendRow(rowItems);
-    }
-    
-    //todayTaskView->resizeColumnsToContents();
+    todayTaskModel->setTasks(getTasksForDate(QDate::currentDate()));
 }
 
 void MainWindow::refreshTodayTodoItems() {
     todayTodoModel->removeRows(0, todayTodoModel->rowCount());
     
-    QDate today = QDate::currentDate();
-    QVector<TODOList> lists = Database::getAllTODOLists();
-    QVector<TODOItem> todayItems;
-    
-    for (const TODOList& list : lists) {
-        if (list.date == today) {
-            QVector<TODOItem> items = Database::getItemsForList(list.id);
-            for (TODOItem& item : items) {
-                todayItems.append(item);
-            }
-        }
-    }
+    QVector<TODOItem> todayItems = Database::getItemsForDate(QDate::currentDate());
     
     for (const TODOItem& item : todayItems) {
         QList<QStandardItem*> rowItems;
@@ -1343,40 +1294,18 @@ void MainWindow::refreshTodayTodoItems() {
 }
 
 void MainWindow::markTaskComplete(int taskId) {
-    Task task;
-    QVector<Task> allTasks = Database::getAllTasks();
-    for (Task& t : allTasks) {
-        if (t.id == taskId) {
-            task = t;
-            break;
-        }
-    }
-    
+    Task task = taskStore.task(taskId);
     if (task.id == -1) return;
     
     task.isCompleted = true;
-    if (Database::updateTask(task)) {
-        refreshTodayTasks();
-        refreshTaskList();  // Update main task list
-        refreshAllViews();  // Update calendar if needed
-    }
+    taskStore.updateTask(task);
 }
 
 QVector<Task> MainWindow::getTasksForDate(const QDate& date) {
-    QVector<Task> result;
-    QVector<Task> allTasks = Database::getAllTasks();
-    
-    for (const Task& task : allTasks) {
-        // Skip completed tasks
-        if (task.isCompleted) continue;
-        
-        // Only include tasks with matching date
-        if (task.deadline.date() == date) {
-            result.append(task);
-        }
-    }
-    
-    return result;
+    // Open tasks due on this date
+    return taskStore.tasksInRange(QDateTime(date, QTime(0, 0)),
+                                  QDateTime(date.addDays(1), QTime(0, 0)),
+                                  false);
 }
 
 void MainWindow::onMarkTaskComplete() {
@@ -1387,8 +1316,7 @@ void MainWindow::onMarkTaskComplete() {
     }
     
     int row = index.row();
-    QStandardItem* idItem = todayTaskModel->item(row, 0);
-    int taskId = idItem->data().toInt();
+    int taskId = todayTaskModel->taskAt(row).id;
     
     markTaskComplete(taskId);
 }
@@ -1408,22 +1336,7 @@ void MainWindow::onMarkTodoComplete() {
 }
 
 void MainWindow::toggleTodoItemCompletion(int itemId) {
-    TODOItem item;
-    QVector<TODOItem> allItems;
-    
-    // Find the item
-    QVector<TODOList> lists = Database::getAllTODOLists();
-    for (const TODOList& list : lists) {
-        QVector<TODOItem> items = Database::getItemsForList(list.id);
-        for (const TODOItem& i : items) {
-            if (i.id == itemId) {
-                item = i;
-                break;
-            }
-        }
-        if (item.id != -1) break;
-    }
-    
+    TODOItem item = Database::getTODOItemById(itemId);
     if (item.id == -1) return;
     
     // Toggle completion status
@@ -1431,8 +1344,6 @@ void MainWindow::toggleTodoItemCompletion(int itemId) {
     item.completed = newStatus;
     
     if (Database::updateTODOItem(item)) {
-        refreshTodayTodoItems();
-        
         // Show status message
         QString status = newStatus ? "marked complete" : "marked incomplete";
         QString title = item.title;
@@ -1457,8 +1368,6 @@ void MainWindow::deleteTODOList() {
     
     if (ret == QMessageBox::Yes) {
         if (Database::deleteTODOList(listId)) {
-            loadTODOListsForDate(todoDateEdit->date());
-            todoItemModel->removeRows(0, todoItemModel->rowCount());
             statusBar()->showMessage("Plan deleted", 3000);
         } else {
             QMessageBox::warning(this, "Error", "Failed to delete plan.");
@@ -1486,7 +1395,6 @@ void MainWindow::deleteTODOItem() {
     
     if (ret == QMessageBox::Yes) {
         if (Database::deleteTODOItem(itemId)) {
-            loadTODOItemsForList(todoListView->currentIndex());
             statusBar()->showMessage("Item deleted", 3000);
         } else {
             QMessageBox::warning(this, "Error", "Failed to delete item.");
@@ -1512,33 +1420,16 @@ void MainWindow::createFromTemplate() {
         return;
     }
     
-    // Create the TODO list
+    // Create the TODO list and copy the template items into it
     TODOList newList;
     newList.name = "Daily Plan";
     newList.date = todoDateEdit->date();
     
-    if (!Database::createTODOList(newList)) {
+    if (!Database::createTODOListFromTemplate(newList, templateId)) {
         QMessageBox::warning(this, "Error", "Failed to create plan.");
         return;
     }
     
-    // Get template items
-    QVector<TemplateItem> templateItems = Database::getItemsForTemplate(templateId);
-    
-    // Create TODO items from template
-    for (const TemplateItem& tplItem : templateItems) {
-        TODOItem newItem;
-        newItem.listId = newList.id;
-        newItem.title = tplItem.title;
-        newItem.description = tplItem.description;
-        newItem.priority = tplItem.priority;
-        newItem.duration = tplItem.duration;
-        
-        Database::createTODOItem(newItem);
-    }
-    
-    // Refresh UI
-    loadTODOListsForDate(todoDateEdit->date());
     statusBar()->showMessage("Plan created from template", 3000);
 }
 
@@ -1564,31 +1455,14 @@ void MainWindow::saveAsTemplate() {
     
     if (!ok || name.isEmpty()) return;
     
-    // Create template
+    // Create template with a copy of the plan items
     Template newTemplate;
     newTemplate.name = name;
-    if (!Database::createTemplate(newTemplate)) {
+    if (!Database::createTemplateFromList(newTemplate, listId)) {
         QMessageBox::warning(this, "Error", "Failed to create template.");
         return;
     }
     
-    // Get plan items
-    QVector<TODOItem> planItems = Database::getItemsForList(listId);
-    
-    // Create template items
-    for (const TODOItem& planItem : planItems) {
-        TemplateItem newItem;
-        newItem.templateId = newTemplate.id;
-        newItem.title = planItem.title;
-        newItem.description = planItem.description;
-        newItem.priority = planItem.priority;
-        newItem.duration = planItem.duration;
-        
-        Database::createTemplateItem(newItem);
-    }
-    
-    // Refresh template list
-    refreshTemplateCombo();
     statusBar()->showMessage("Template saved", 3000);
 }
 
@@ -1637,7 +1511,65 @@ void MainWindow::manageTemplates() {
     connect(&buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
     
     dialog.exec();
-    refreshTemplateCombo();
+}
+
+void MainWindow::showArchive() {
+    QDialog dialog(this);
+    dialog.setWindowTitle("Task Archive");
+    dialog.resize(640, 420);
+    QVBoxLayout layout(&dialog);
+
+    QLineEdit* searchEdit = new QLineEdit(&dialog);
+    searchEdit->setPlaceholderText("Search archived tasks...");
+
+    QStandardItemModel* archiveModel = new QStandardItemModel(0, 3, &dialog);
+    archiveModel->setHorizontalHeaderLabels({"Title", "Deadline", "Priority"});
+    QTableView* archiveView = new QTableView(&dialog);
+    archiveView->setModel(archiveModel);
+    archiveView->setSelectionBehavior(QAbstractItemView::SelectRows);
+    archiveView->setSelectionMode(QAbstractItemView::SingleSelection);
+    archiveView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    archiveView->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+
+    // Archived tasks are only read here, on demand
+    auto loadArchive = [=]() {
+        archiveModel->removeRows(0, archiveModel->rowCount());
+        const QVector<Task> tasks = Database::getArchivedTasks(searchEdit->text());
+        for (const Task& task : tasks) {
+            QStandardItem* titleItem = new QStandardItem(task.title);
+            titleItem->setData(task.id);
+            archiveModel->appendRow({
+                titleItem,
+                new QStandardItem(task.deadline.toString("dd/MM/yyyy hh:mm")),
+                new QStandardItem(priorityNames.value(task.priority, "None"))
+            });
+        }
+    };
+    loadArchive();
+
+    QPushButton* reopenButton = new QPushButton("Reopen Task", &dialog);
+    QDialogButtonBox buttonBox(QDialogButtonBox::Close, &dialog);
+
+    layout.addWidget(searchEdit);
+    layout.addWidget(archiveView);
+    layout.addWidget(reopenButton);
+    layout.addWidget(&buttonBox);
+
+    connect(searchEdit, &QLineEdit::textChanged, &dialog, loadArchive);
+    connect(reopenButton, &QPushButton::clicked, [&]() {
+        QModelIndex current = archiveView->currentIndex();
+        if (!current.isValid()) return;
+
+        int taskId = archiveModel->item(current.row(), 0)->data().toInt();
+        if (Database::unarchiveTask(taskId)) {
+            archiveModel->removeRow(current.row());
+        } else {
+            QMessageBox::warning(&dialog, "Error", "Failed to reopen task");
+        }
+    });
+    connect(&buttonBox, &QDialogButtonBox::rejected, &dialog, &QDialog::reject);
+
+    dialog.exec();
 }
 
 void MainWindow::updatePlanStatus() {
@@ -1742,15 +1674,11 @@ void MainWindow::showTodoItemDetailsDialog(const TODOItem& item) {
 
 void MainWindow::onTaskDoubleClicked(const QModelIndex& index) {
     QModelIndex sourceIndex = proxyModel->mapToSource(index);
-    QStandardItem* idItem = model->item(sourceIndex.row(), 0);
-    int taskId = idItem->data().toInt();
-    
-    QVector<Task> allTasks = Database::getAllTasks();
-    for (const Task& task : allTasks) {
-        if (task.id == taskId) {
-            showTaskDetailsDialog(task);
-            break;
-        }
+    int taskId = model->taskAt(sourceIndex.row()).id;
+    
+    Task task = taskStore.task(taskId);
+    if (task.id != -1) {
+        showTaskDetailsDialog(task);
     }
 }
 
@@ -1759,29 +1687,19 @@ void MainWindow::onTodoItemDoubleClicked(const QModelIndex& index) {
     QStandardItem* idItem = todoItemModel->item(row, 0);
     int itemId = idItem->data().toInt();
     
-    QVector<TODOList> lists = Database::getAllTODOLists();
-    for (const TODOList& list : lists) {
-        QVector<TODOItem> items = Database::getItemsForList(list.id);
-        for (const TODOItem& item : items) {
-            if (item.id == itemId) {
-                showTodoItemDetailsDialog(item);
-                return;
-            }
-        }
+    TODOItem item = Database::getTODOItemById(itemId);
+    if (item.id != -1) {
+        showTodoItemDetailsDialog(item);
     }
 }
 
 void MainWindow::onTodayTaskDoubleClicked(const QModelIndex& index) {
     int row = index.row();
-    QStandardItem* idItem = todayTaskModel->item(row, 0);
-    int taskId = idItem->data().toInt();
-    
-    QVector<Task> allTasks = Database::getAllTasks();
-    for (const Task& task : allTasks) {
-        if (task.id == taskId) {
-            showTaskDetailsDialog(task);
-            break;
-        }
+    int taskId = todayTaskModel->taskAt(row).id;
+    
+    Task task = taskStore.task(taskId);
+    if (task.id != -1) {
+        showTaskDetailsDialog(task);
     }
 }
 
@@ -1790,15 +1708,9 @@ void MainWindow::onTodayTodoItemDoubleClicked(const QModelIndex& index) {
     QStandardItem* idItem = todayTodoModel->item(row, 0);
     int itemId = idItem->data().toInt();
     
-    QVector<TODOList> lists = Database::getAllTODOLists();
-    for (const TODOList& list : lists) {
-        QVector<TODOItem> items = Database::getItemsForList(list.id);
-        for (const TODOItem& item : items) {
-            if (item.id == itemId) {
-                showTodoItemDetailsDialog(item);
-                return;
-            }
-        }
+    TODOItem item = Database::getTODOItemById(itemId);
+    if (item.id != -1) {
+        showTodoItemDetailsDialog(item);
     }
 }
 
@@ -1808,39 +1720,24 @@ void MainWindow::updateCalendarTaskDetails(const QModelIndex &current) {
         return;
     }
     
-    int row = current.row();
-    QString title = calendarModel->item(row, 0)->text();
-    QString priority = calendarModel->item(row, 1)->text();
-    QString status = calendarModel->item(row, 2)->text();
-    QString time = calendarModel->item(row, 3)->text();
-    
-    // Get full task details (you'll need to implement this)
-    Task task = getTaskByTitleAndDate(title, calendarWidget->selectedDate());
+    const Task& task = calendarModel->taskAt(current.row());
+    QString status = calendarModel->index(current.row(), calendarModel->columnOf(TaskTableModel::Column::Status))
+                         .data().toString();
     
     QString details = QString("<h2>%1</h2>"
                             "<p><b>Status:</b> %2</p>"
                             "<p><b>Priority:</b> %3</p>"
                             "<p><b>Time:</b> %4</p>"
                             "<hr><p>%5</p>")
-                    .arg(title)
+                    .arg(task.title)
                     .arg(status)
-                    .arg(priority)
-                    .arg(time)
+                    .arg(priorityNames.value(task.priority, "None"))
+                    .arg(task.deadline.time().toString("hh:mm"))
                     .arg(formatDescription(task.description));
     
     calendarDetailsView->setHtml(details);
 }
 
-Task MainWindow::getTaskByTitleAndDate(const QString& title, const QDate& date) {
-    QVector<Task> tasks = Database::getAllTasks();
-    for (const Task& task : tasks) {
-        if (task.title == title && task.deadline.date() == date) {
-            return task;
-        }
-    }
-    return Task(); // return empty task if not found
-}
-
 bool MainWindow::eventFilter(QObject *obj, QEvent *event) {
     if (event->type() == QEvent::KeyPress) {
         QKeyEvent *keyEvent = static_cast<QKeyEvent*>(event);
@@ -1877,11 +1774,13 @@ void MainWindow::backupDatabase() {
                                                    "Database Files (*.db)");
     if (backupPath.isEmpty()) return;
     
-    if (Database::backupDatabase(backupPath)) {
-        QMessageBox::information(this, "Success", "Database backup created successfully!");
-    } else {
-        QMessageBox::warning(this, "Error", "Failed to create backup");
-    }
+    watchDatabaseJob("Creating backup...", dbWorker->backupDatabase(backupPath), [this](bool success) {
+        if (success) {
+            QMessageBox::information(this, "Success", "Database backup created successfully!");
+        } else {
+            QMessageBox::warning(this, "Error", "Failed to create backup");
+        }
+    });
 }
 
 void MainWindow::restoreDatabase() {
@@ -1899,12 +1798,22 @@ void MainWindow::restoreDatabase() {
     
     if (confirm != QMessageBox::Yes) return;
     
-    if (Database::restoreDatabase(backupPath)) {
-        refreshAllViews();
-        QMessageBox::information(this, "Success", "Database restored successfully!");
-    } else {
-        QMessageBox::warning(this, "Error", "Failed to restore database");
-    }
+    // The worker swaps the file in on its own connection; this thread's
+    // is closed meanwhile. The dataReset it sends is delivered before the
+    // job's result and only marks views dirty, so they reload once the
+    // connection is back.
+    Database::suspendConnection();
+    watchDatabaseJob("Restoring database...", dbWorker->restoreDatabase(backupPath), [this](bool success) {
+        if (!Database::resumeConnection()) {
+            QMessageBox::critical(this, "Error", "Could not reopen the database");
+            return;
+        }
+        if (success) {
+            QMessageBox::information(this, "Success", "Database restored successfully!");
+        } else {
+            QMessageBox::warning(this, "Error", "Failed to restore database");
+        }
+    });
 }
 
 void MainWindow::exportDatabase() {
@@ -1914,11 +1823,13 @@ void MainWindow::exportDatabase() {
                                                   "SQL Files (*.sql)");
     if (filePath.isEmpty()) return;
     
-    if (Database::exportToSQL(filePath)) {
-        QMessageBox::information(this, "Success", "Database exported to SQL successfully!");
-    } else {
-        QMessageBox::warning(this, "Error", "Failed to export database");
-    }
+    watchDatabaseJob("Exporting database...", dbWorker->exportToSQL(filePath), [this](bool success) {
+        if (success) {
+            QMessageBox::information(this, "Success", "Database exported to SQL successfully!");
+        } else {
+            QMessageBox::warning(this, "Error", "Failed to export database");
+        }
+    });
 }
 
 void MainWindow::importDatabase() {
@@ -1936,10 +1847,156 @@ void MainWindow::importDatabase() {
     
     if (confirm != QMessageBox::Yes) return;
     
-    if (Database::importFromSQL(filePath)) {
-        refreshAllViews();
-        QMessageBox::information(this, "Success", "Database imported successfully!");
-    } else {
-        QMessageBox::warning(this, "Error", "Failed to import database");
-    }
+    watchDatabaseJob("Importing database...", dbWorker->importFromSQL(filePath), [this](bool success) {
+        if (success) {
+            QMessageBox::information(this, "Success", "Database imported successfully!");
+        } else {
+            QMessageBox::warning(this, "Error", "Failed to import database");
+        }
+    });
+}
+
+void MainWindow::exportSnapshot() {
+    QString defaultPath = QDir::homePath() + "/taskmanager.tmsnap";
+    QString filePath = QFileDialog::getSaveFileName(this, "Export Snapshot",
+                                                  defaultPath,
+                                                  "TaskManager Snapshots (*.tmsnap)");
+    if (filePath.isEmpty()) return;
+
+    watchDatabaseJob("Exporting snapshot...", dbWorker->exportSnapshot(filePath), [this](bool success) {
+        if (success) {
+            QMessageBox::information(this, "Success", "Snapshot exported successfully!");
+        } else {
+            QMessageBox::warning(this, "Error", "Failed to export snapshot");
+        }
+    });
+}
+
+void MainWindow::importSnapshot() {
+    QString filePath = QFileDialog::getOpenFileName(this, "Import Snapshot",
+                                                  QDir::homePath(),
+                                                  "TaskManager Snapshots (*.tmsnap)");
+    if (filePath.isEmpty()) return;
+
+    QMessageBox::StandardButton confirm = QMessageBox::question(
+        this,
+        "Confirm Import",
+        "This will replace your current database. Continue?",
+        QMessageBox::Yes | QMessageBox::No
+    );
+
+    if (confirm != QMessageBox::Yes) return;
+
+    watchDatabaseJob("Importing snapshot...", dbWorker->importSnapshot(filePath), [this](bool success) {
+        if (success) {
+            QMessageBox::information(this, "Success", "Snapshot imported successfully!");
+        } else {
+            QMessageBox::warning(this, "Error", "Failed to import snapshot");
+        }
+    });
+}
+
+void MainWindow::exportJsonLines() {
+    QString defaultPath = QDir::homePath() + "/taskmanager.jsonl";
+    QString filePath = QFileDialog::getSaveFileName(this, "Export to JSON Lines",
+                                                  defaultPath,
+                                                  "JSON Lines (*.jsonl)");
+    if (filePath.isEmpty()) return;
+
+    auto stats = std::make_shared<Database::TransferStats>();
+    watchDatabaseJob("Exporting JSON Lines...", dbWorker->exportToJsonLines(filePath, stats), [this, stats](bool success) {
+        if (success) {
+            QMessageBox::information(this, "Success", "Exported " + describeTransfer(*stats));
+        } else {
+            QMessageBox::warning(this, "Error", "Failed to export JSON Lines");
+        }
+    });
+}
+
+void MainWindow::importJsonLines() {
+    QString filePath = QFileDialog::getOpenFileName(this, "Import from JSON Lines",
+                                                  QDir::homePath(),
+                                                  "JSON Lines (*.jsonl)");
+    if (filePath.isEmpty()) return;
+
+    QMessageBox::StandardButton confirm = QMessageBox::question(
+        this,
+        "Confirm Import",
+        "Imported rows replace existing rows with the same id. Continue?",
+        QMessageBox::Yes | QMessageBox::No
+    );
+
+    if (confirm != QMessageBox::Yes) return;
+
+    auto stats = std::make_shared<Database::TransferStats>();
+    watchDatabaseJob("Importing JSON Lines...", dbWorker->importFromJsonLines(filePath, stats), [this, stats](bool success) {
+        if (success) {
+            QMessageBox::information(this, "Success", "Imported " + describeTransfer(*stats));
+        } else {
+            QMessageBox::warning(this, "Error", "Failed to import JSON Lines");
+        }
+    });
+}
+
+void MainWindow::exportCsv() {
+    QString directory = QFileDialog::getExistingDirectory(this, "Export to CSV", QDir::homePath());
+    if (directory.isEmpty()) return;
+
+    auto stats = std::make_shared<Database::TransferStats>();
+    watchDatabaseJob("Exporting CSV...", dbWorker->exportToCsv(directory, stats), [this, stats](bool success) {
+        if (success) {
+            QMessageBox::information(this, "Success", "Exported " + describeTransfer(*stats));
+        } else {
+            QMessageBox::warning(this, "Error", "Failed to export CSV");
+        }
+    });
+}
+
+void MainWindow::importCsv() {
+    QString directory = QFileDialog::getExistingDirectory(this, "Import from CSV", QDir::homePath());
+    if (directory.isEmpty()) return;
+
+    QMessageBox::StandardButton confirm = QMessageBox::question(
+        this,
+        "Confirm Import",
+        "Imported rows replace existing rows with the same id. Continue?",
+        QMessageBox::Yes | QMessageBox::No
+    );
+
+    if (confirm != QMessageBox::Yes) return;
+
+    auto stats = std::make_shared<Database::TransferStats>();
+    watchDatabaseJob("Importing CSV...", dbWorker->importFromCsv(directory, stats), [this, stats](bool success) {
+        if (success) {
+            QMessageBox::information(this, "Success", "Imported " + describeTransfer(*stats));
+        } else {
+            QMessageBox::warning(this, "Error", "Failed to import CSV");
+        }
+    });
+}
+
+QString MainWindow::describeTransfer(const Database::TransferStats& stats) {
+    return QString("%L1 rows in %2 s (%L3 rows/s)")
+        .arg(stats.rows)
+        .arg(stats.elapsedMs / 1000.0, 0, 'f', 1)
+        .arg(qRound64(stats.rowsPerSecond()));
+}
+
+void MainWindow::watchDatabaseJob(const QString& label, const QFuture<bool>& job,
+                                  const std::function<void(bool)>& onFinished) {
+    // Window-modal so the user can't edit while the worker owns the data
+    QProgressDialog* progress = new QProgressDialog(label, QString(), 0, 0, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(300);
+    progress->setValue(0);
+
+    QFutureWatcher<bool>* watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::progressRangeChanged, progress, &QProgressDialog::setRange);
+    connect(watcher, &QFutureWatcher<bool>::progressValueChanged, progress, &QProgressDialog::setValue);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [watcher, progress, onFinished]() {
+        progress->deleteLater();
+        watcher->deleteLater();
+        onFinished(watcher->result());
+    });
+    watcher->setFuture(job);
 }
\ No newline at end of file
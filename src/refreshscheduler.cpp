@@ -0,0 +1,47 @@
+#include "refreshscheduler.h"
+#include <QTabWidget>
+
+RefreshScheduler::RefreshScheduler(QTabWidget* tabs, QObject* parent)
+    : QObject(parent), m_tabs(tabs) {
+    m_timer.setSingleShot(true);
+    connect(&m_timer, &QTimer::timeout, this, &RefreshScheduler::flush);
+    // Catch up before the newly shown tab is painted
+    connect(m_tabs, &QTabWidget::currentChanged, this, &RefreshScheduler::tabShown);
+}
+
+void RefreshScheduler::addView(View view, QWidget* page, const std::function<void()>& refresh,
+                               bool everyVisit) {
+    m_views.append({view, page, refresh, everyVisit});
+}
+
+void RefreshScheduler::markDirty(Views views, int delayMs) {
+    m_dirty |= views;
+    if (delayMs <= 0) {
+        m_timer.start(0);
+    } else if (!m_timer.isActive() || m_timer.interval() > 0) {
+        m_timer.start(delayMs);
+    }
+}
+
+void RefreshScheduler::tabShown() {
+    for (const Entry& entry : m_views) {
+        if (entry.everyVisit && entry.page == m_tabs->currentWidget()) {
+            m_dirty |= entry.view;
+        }
+    }
+    flush();
+}
+
+void RefreshScheduler::flush() {
+    m_timer.stop();
+    if (!m_dirty) return;
+
+    for (const Entry& entry : m_views) {
+        if (!m_dirty.testFlag(entry.view)) continue;
+        if (entry.page && m_tabs->currentWidget() != entry.page) continue;
+
+        // Cleared first, so a refresh may mark it dirty again
+        m_dirty.setFlag(entry.view, false);
+        entry.refresh();
+    }
+}
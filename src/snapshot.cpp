@@ -0,0 +1,330 @@
+#include "snapshot.h"
+#include <QIODevice>
+#include <QtEndian>
+#include <cstring>
+
+namespace {
+    const char kMagic[8] = {'T', 'M', 'S', 'N', 'A', 'P', '\0', '\0'};
+
+    enum ValueTag : uchar {
+        NullValue = 0,
+        IntegerValue = 1,
+        RealValue = 2,
+        TextValue = 3,
+        BlobValue = 4
+    };
+
+    // CRC-32 (IEEE), table driven; can be fed in pieces
+    quint32 crc32(quint32 crc, const uchar* data, qint64 size) {
+        static const QVector<quint32> table = []() {
+            QVector<quint32> t(256);
+            for (quint32 i = 0; i < 256; ++i) {
+                quint32 c = i;
+                for (int bit = 0; bit < 8; ++bit) {
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                }
+                t[i] = c;
+            }
+            return t;
+        }();
+
+        crc = ~crc;
+        for (qint64 i = 0; i < size; ++i) {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+    void appendUInt32(QByteArray& out, quint32 value) {
+        char bytes[4];
+        qToLittleEndian(value, bytes);
+        out.append(bytes, 4);
+    }
+
+    void appendUInt64(QByteArray& out, quint64 value) {
+        char bytes[8];
+        qToLittleEndian(value, bytes);
+        out.append(bytes, 8);
+    }
+
+    // Bounds-checked reads from the mapped file
+    struct Input {
+        const uchar* pos;
+        const uchar* end;
+
+        bool take(quint64 size, const uchar*& out) {
+            if (quint64(end - pos) < size) return false;
+            out = pos;
+            pos += size;
+            return true;
+        }
+
+        bool readUInt32(quint32& value) {
+            const uchar* bytes;
+            if (!take(4, bytes)) return false;
+            value = qFromLittleEndian<quint32>(bytes);
+            return true;
+        }
+
+        bool readUInt64(quint64& value) {
+            const uchar* bytes;
+            if (!take(8, bytes)) return false;
+            value = qFromLittleEndian<quint64>(bytes);
+            return true;
+        }
+
+        bool readString(QString& value) {
+            quint32 size;
+            const uchar* bytes;
+            if (!readUInt32(size) || !take(size, bytes)) return false;
+            value = QString::fromUtf8(reinterpret_cast<const char*>(bytes), int(size));
+            return true;
+        }
+    };
+}
+
+SnapshotWriter::SnapshotWriter(QIODevice* device)
+    : m_device(device), m_crc(0) {}
+
+bool SnapshotWriter::begin(int schemaVersion, int tableCount) {
+    return write(QByteArray(kMagic, sizeof(kMagic))) &&
+           writeUInt32(kFormatVersion) &&
+           writeUInt32(quint32(schemaVersion)) &&
+           writeUInt32(quint32(tableCount));
+}
+
+bool SnapshotWriter::beginTable(const QString& name, const QStringList& columns, quint64 rowCount) {
+    if (!writeString(name) ||
+        !writeUInt64(rowCount) ||
+        !writeUInt32(quint32(columns.size()))) {
+        return false;
+    }
+    for (const QString& column : columns) {
+        if (!writeString(column)) return false;
+    }
+    return true;
+}
+
+bool SnapshotWriter::writeChunk(quint32 rowCount, const QVector<QByteArray>& columnData) {
+    if (!writeUInt32(rowCount)) return false;
+    for (const QByteArray& data : columnData) {
+        if (!writeUInt64(quint64(data.size())) || !write(data)) return false;
+    }
+    return true;
+}
+
+bool SnapshotWriter::finish() {
+    QByteArray checksum;
+    appendUInt32(checksum, m_crc);
+    return m_device->write(checksum) == checksum.size();
+}
+
+void SnapshotWriter::appendValue(QByteArray& column, const QVariant& value) {
+    if (value.isNull()) {
+        column += char(NullValue);
+        return;
+    }
+
+    switch (value.type()) {
+        case QVariant::Bool:
+        case QVariant::Int:
+        case QVariant::UInt:
+        case QVariant::LongLong:
+        case QVariant::ULongLong:
+            column += char(IntegerValue);
+            appendUInt64(column, quint64(value.toLongLong()));
+            break;
+        case QVariant::Double: {
+            double real = value.toDouble();
+            quint64 bits;
+            std::memcpy(&bits, &real, sizeof(bits));
+            column += char(RealValue);
+            appendUInt64(column, bits);
+            break;
+        }
+        case QVariant::ByteArray: {
+            const QByteArray blob = value.toByteArray();
+            column += char(BlobValue);
+            appendUInt32(column, quint32(blob.size()));
+            column += blob;
+            break;
+        }
+        default: {
+            const QByteArray text = value.toString().toUtf8();
+            column += char(TextValue);
+            appendUInt32(column, quint32(text.size()));
+            column += text;
+            break;
+        }
+    }
+}
+
+bool SnapshotWriter::write(const QByteArray& data) {
+    m_crc = crc32(m_crc, reinterpret_cast<const uchar*>(data.constData()), data.size());
+    return m_device->write(data) == data.size();
+}
+
+bool SnapshotWriter::writeUInt32(quint32 value) {
+    QByteArray bytes;
+    appendUInt32(bytes, value);
+    return write(bytes);
+}
+
+bool SnapshotWriter::writeUInt64(quint64 value) {
+    QByteArray bytes;
+    appendUInt64(bytes, value);
+    return write(bytes);
+}
+
+bool SnapshotWriter::writeString(const QString& value) {
+    const QByteArray utf8 = value.toUtf8();
+    return writeUInt32(quint32(utf8.size())) && write(utf8);
+}
+
+SnapshotReader::Cursor::Cursor(const Column& column)
+    : m_pos(column.data), m_end(column.data + column.size) {}
+
+bool SnapshotReader::Cursor::next(QVariant& value) {
+    if (m_pos >= m_end) return false;
+    const uchar tag = *m_pos++;
+
+    switch (tag) {
+        case NullValue:
+            value = QVariant();
+            return true;
+        case IntegerValue:
+        case RealValue: {
+            if (m_end - m_pos < 8) return false;
+            quint64 bits = qFromLittleEndian<quint64>(m_pos);
+            m_pos += 8;
+            if (tag == IntegerValue) {
+                value = qint64(bits);
+            } else {
+                double real;
+                std::memcpy(&real, &bits, sizeof(real));
+                value = real;
+            }
+            return true;
+        }
+        case TextValue:
+        case BlobValue: {
+            if (m_end - m_pos < 4) return false;
+            quint32 size = qFromLittleEndian<quint32>(m_pos);
+            m_pos += 4;
+            if (quint64(m_end - m_pos) < size) return false;
+            const char* bytes = reinterpret_cast<const char*>(m_pos);
+            m_pos += size;
+            if (tag == TextValue) {
+                value = QString::fromUtf8(bytes, int(size));
+            } else {
+                value = QByteArray(bytes, int(size));
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+bool SnapshotReader::open(const QString& path) {
+    m_tables.clear();
+    m_fallback.clear();
+    m_error.clear();
+    if (m_file.isOpen()) m_file.close();
+
+    m_file.setFileName(path);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return fail(m_file.errorString());
+    }
+
+    const qint64 size = m_file.size();
+    const qint64 headerSize = sizeof(kMagic) + 3 * 4;
+    if (size < headerSize + 4) {
+        return fail("File is too short to be a snapshot");
+    }
+
+    const uchar* data = m_file.map(0, size);
+    if (!data) {
+        m_fallback = m_file.readAll();
+        if (m_fallback.size() != size) return fail(m_file.errorString());
+        data = reinterpret_cast<const uchar*>(m_fallback.constData());
+    }
+
+    if (std::memcmp(data, kMagic, sizeof(kMagic)) != 0) {
+        return fail("Not a TaskManager snapshot");
+    }
+    if (crc32(0, data, size - 4) != qFromLittleEndian<quint32>(data + size - 4)) {
+        return fail("Checksum mismatch; the snapshot is damaged");
+    }
+
+    Input in{data + sizeof(kMagic), data + size - 4};
+    quint32 formatVersion, schemaVersion, tableCount;
+    in.readUInt32(formatVersion);
+    in.readUInt32(schemaVersion);
+    in.readUInt32(tableCount);
+    if (formatVersion > SnapshotWriter::kFormatVersion) {
+        return fail(QString("Snapshot format %1 is newer than this version supports").arg(formatVersion));
+    }
+    m_schemaVersion = int(schemaVersion);
+
+    for (quint32 t = 0; t < tableCount; ++t) {
+        Table table;
+        quint32 columnCount;
+        if (!in.readString(table.name) || !in.readUInt64(table.rowCount) || !in.readUInt32(columnCount)) {
+            return fail("Truncated table header");
+        }
+        if (columnCount > quint64(in.end - in.pos)) {
+            return fail("Truncated table header");
+        }
+        for (quint32 c = 0; c < columnCount; ++c) {
+            QString name;
+            if (!in.readString(name)) return fail("Truncated table header");
+            table.columns << name;
+        }
+
+        quint64 remaining = table.rowCount;
+        while (remaining > 0) {
+            Chunk chunk;
+            quint32 rowCount;
+            if (!in.readUInt32(rowCount)) {
+                return fail(QString("Truncated chunk in %1").arg(table.name));
+            }
+            if (rowCount == 0 || rowCount > remaining) {
+                return fail(QString("Chunk sizes in %1 don't add up to its row count").arg(table.name));
+            }
+            chunk.rowCount = rowCount;
+
+            chunk.columns.resize(int(columnCount));
+            for (Column& column : chunk.columns) {
+                quint64 blockSize;
+                if (!in.readUInt64(blockSize) || !in.take(blockSize, column.data)) {
+                    return fail(QString("Truncated column block in %1").arg(table.name));
+                }
+                column.size = qint64(blockSize);
+            }
+            remaining -= chunk.rowCount;
+            table.chunks.append(chunk);
+        }
+
+        m_tables.append(table);
+    }
+
+    if (in.pos != in.end) {
+        return fail("Unexpected data after the last table");
+    }
+    return true;
+}
+
+quint64 SnapshotReader::totalRows() const {
+    quint64 total = 0;
+    for (const Table& table : m_tables) {
+        total += table.rowCount;
+    }
+    return total;
+}
+
+bool SnapshotReader::fail(const QString& error) {
+    m_error = error;
+    m_tables.clear();
+    return false;
+}
@@ -0,0 +1,224 @@
+#include "sqlstatementreader.h"
+#include <QIODevice>
+#include <QByteArray>
+
+namespace {
+    bool isIdentifierChar(QChar c) {
+        return c.isLetterOrNumber() || c == '_' || c == '$';
+    }
+
+    bool isInsert(const QString& sql) {
+        return sql.startsWith("INSERT", Qt::CaseInsensitive) ||
+               sql.startsWith("REPLACE", Qt::CaseInsensitive);
+    }
+}
+
+SqlStatementReader::SqlStatementReader(QIODevice* device, int chunkSize)
+    : m_device(device), m_stream(device), m_chunkSize(chunkSize) {
+    m_stream.setCodec("UTF-8");
+}
+
+qint64 SqlStatementReader::bytesRead() const {
+    return m_device->pos();
+}
+
+bool SqlStatementReader::fill() {
+    m_buffer = m_stream.read(m_chunkSize);
+    m_pos = 0;
+    return !m_buffer.isEmpty();
+}
+
+bool SqlStatementReader::next(Statement& statement) {
+    QString sql;
+
+    for (;;) {
+        if (m_pos == m_buffer.size() && !fill()) {
+            // End of input: flush whatever a pending state was holding back
+            if (m_state == State::MaybeLineComment) sql += '-';
+            if (m_state == State::MaybeBlockComment) sql += '/';
+            m_state = State::Normal;
+
+            statement.sql = sql.trimmed();
+            if (statement.sql.isEmpty()) return false;
+            parameterize(statement);
+            return true;
+        }
+
+        const QChar c = m_buffer.at(m_pos++);
+        switch (m_state) {
+            case State::Normal:
+                if (c == ';') {
+                    statement.sql = sql.trimmed();
+                    if (statement.sql.isEmpty()) {
+                        sql.clear(); // skip empty statements
+                        break;
+                    }
+                    parameterize(statement);
+                    return true;
+                } else if (c == '-') {
+                    m_state = State::MaybeLineComment;
+                } else if (c == '/') {
+                    m_state = State::MaybeBlockComment;
+                } else if (c == '\'' || c == '"' || c == '`') {
+                    m_quote = c;
+                    m_state = State::Quoted;
+                    sql += c;
+                } else if (c == '[') {
+                    m_state = State::Bracketed;
+                    sql += c;
+                } else {
+                    sql += c;
+                }
+                break;
+
+            case State::MaybeLineComment:
+                if (c == '-') {
+                    m_state = State::LineComment;
+                } else {
+                    sql += '-';
+                    m_state = State::Normal;
+                    --m_pos; // reprocess c
+                }
+                break;
+
+            case State::LineComment:
+                if (c == '\n') {
+                    sql += c;
+                    m_state = State::Normal;
+                }
+                break;
+
+            case State::MaybeBlockComment:
+                if (c == '*') {
+                    m_state = State::BlockComment;
+                } else {
+                    sql += '/';
+                    m_state = State::Normal;
+                    --m_pos;
+                }
+                break;
+
+            case State::BlockComment:
+                if (c == '*') m_state = State::BlockCommentStar;
+                break;
+
+            case State::BlockCommentStar:
+                if (c == '/') {
+                    sql += ' '; // keep the tokens on either side apart
+                    m_state = State::Normal;
+                } else if (c != '*') {
+                    m_state = State::BlockComment;
+                }
+                break;
+
+            case State::Quoted:
+                sql += c;
+                if (c == m_quote) m_state = State::QuoteEnd;
+                break;
+
+            case State::QuoteEnd:
+                if (c == m_quote) {
+                    // Doubled quote is an escaped quote; still inside
+                    sql += c;
+                    m_state = State::Quoted;
+                } else {
+                    m_state = State::Normal;
+                    --m_pos;
+                }
+                break;
+
+            case State::Bracketed:
+                sql += c;
+                if (c == ']') m_state = State::Normal;
+                break;
+        }
+    }
+}
+
+void SqlStatementReader::parameterize(Statement& statement) {
+    statement.parameterized.clear();
+    statement.values.clear();
+    if (!isInsert(statement.sql)) return;
+
+    const QString& sql = statement.sql;
+    QString out;
+    out.reserve(sql.size());
+
+    int i = 0;
+    while (i < sql.size()) {
+        const QChar c = sql.at(i);
+        const bool afterIdentifier = i > 0 && isIdentifierChar(sql.at(i - 1));
+
+        if (c == '\'') {
+            // String literal, with '' as an escaped quote
+            QString text;
+            ++i;
+            while (i < sql.size()) {
+                if (sql.at(i) == '\'') {
+                    if (i + 1 < sql.size() && sql.at(i + 1) == '\'') {
+                        text += '\'';
+                        i += 2;
+                        continue;
+                    }
+                    break;
+                }
+                text += sql.at(i++);
+            }
+            ++i; // closing quote
+            out += '?';
+            statement.values << text;
+        } else if ((c == 'X' || c == 'x') && !afterIdentifier &&
+                   i + 1 < sql.size() && sql.at(i + 1) == '\'') {
+            // Blob literal X'...'
+            int end = sql.indexOf('\'', i + 2);
+            if (end < 0) end = sql.size();
+            out += '?';
+            statement.values << QByteArray::fromHex(sql.mid(i + 2, end - i - 2).toLatin1());
+            i = end + 1;
+        } else if (c == '"' || c == '`' || c == '[') {
+            // Quoted identifier, copied verbatim
+            const QChar close = c == '[' ? QChar(']') : c;
+            int end = sql.indexOf(close, i + 1);
+            if (end < 0) end = sql.size() - 1;
+            out += sql.midRef(i, end - i + 1);
+            i = end + 1;
+        } else if (!afterIdentifier && (c.isDigit() ||
+                   (c == '.' && i + 1 < sql.size() && sql.at(i + 1).isDigit()))) {
+            // Numeric literal
+            int start = i;
+            bool real = false;
+            if (c == '0' && i + 1 < sql.size() && (sql.at(i + 1) == 'x' || sql.at(i + 1) == 'X')) {
+                i += 2;
+                while (i < sql.size() && isIdentifierChar(sql.at(i))) ++i;
+                out += '?';
+                statement.values << sql.mid(start + 2, i - start - 2).toLongLong(nullptr, 16);
+                continue;
+            }
+            while (i < sql.size() && (sql.at(i).isDigit() || sql.at(i) == '.')) {
+                if (sql.at(i) == '.') real = true;
+                ++i;
+            }
+            if (i < sql.size() && (sql.at(i) == 'e' || sql.at(i) == 'E')) {
+                real = true;
+                ++i;
+                if (i < sql.size() && (sql.at(i) == '+' || sql.at(i) == '-')) ++i;
+                while (i < sql.size() && sql.at(i).isDigit()) ++i;
+            }
+
+            const QString number = sql.mid(start, i - start);
+            bool ok = false;
+            qlonglong integer = real ? 0 : number.toLongLong(&ok);
+            out += '?';
+            if (ok) {
+                statement.values << integer;
+            } else {
+                statement.values << number.toDouble();
+            }
+        } else {
+            out += c;
+            ++i;
+        }
+    }
+
+    statement.parameterized = out;
+}
@@ -0,0 +1,88 @@
+#include "taskfilterengine.h"
+#include <QRegExp>
+
+QStringList TaskFilterEngine::searchKey(const Task& task) {
+    return fold(task.title) + fold(task.description);
+}
+
+bool TaskFilterEngine::narrows(const Database::TaskFilter& wider, const Database::TaskFilter& narrower) {
+    if (wider.priority >= 0 && wider.priority != narrower.priority) return false;
+    if (!wider.includeCompleted && narrower.includeCompleted) return false;
+    if (wider.from.isValid() && !(narrower.from.isValid() && narrower.from >= wider.from)) return false;
+    if (wider.to.isValid() && !(narrower.to.isValid() && narrower.to <= wider.to)) return false;
+
+    // Every word of the wider search must be implied by one of the narrower
+    const QVector<Term> widerTerms = terms(wider.text);
+    if (widerTerms.isEmpty()) return wider.text.trimmed().isEmpty();
+    const QVector<Term> narrowerTerms = terms(narrower.text);
+    for (const Term& term : widerTerms) {
+        bool implied = false;
+        for (const Term& candidate : narrowerTerms) {
+            if (implies(candidate, term)) {
+                implied = true;
+                break;
+            }
+        }
+        if (!implied) return false;
+    }
+    return true;
+}
+
+void TaskFilterEngine::setFilter(const Database::TaskFilter& filter) {
+    m_filter = filter;
+    m_terms = terms(filter.text);
+    // Search text without a searchable word matches nothing, as in SQL
+    m_matchesNothing = m_terms.isEmpty() && !filter.text.trimmed().isEmpty();
+}
+
+bool TaskFilterEngine::matches(const Task& task, const QStringList& key) const {
+    if (m_matchesNothing) return false;
+    if (m_filter.priority >= 0 && task.priority != m_filter.priority) return false;
+    if (!m_filter.includeCompleted && task.isCompleted) return false;
+    if (m_filter.from.isValid() && task.deadline < m_filter.from) return false;
+    if (m_filter.to.isValid() && task.deadline >= m_filter.to) return false;
+
+    for (const Term& term : m_terms) {
+        // Leading tokens match whole words, the last one as a prefix
+        bool found = false;
+        for (int i = 0; !found && i + term.size() <= key.size(); ++i) {
+            found = key.at(i + term.size() - 1).startsWith(term.last());
+            for (int j = 0; found && j < term.size() - 1; ++j) {
+                found = key.at(i + j) == term.at(j);
+            }
+        }
+        if (!found) return false;
+    }
+    return true;
+}
+
+QStringList TaskFilterEngine::fold(const QString& text) {
+    // Decompose, drop the accents and lower-case, like unicode61
+    QString folded;
+    const QString decomposed = text.normalized(QString::NormalizationForm_D);
+    folded.reserve(decomposed.size());
+    for (const QChar& c : decomposed) {
+        if (c.category() == QChar::Mark_NonSpacing) continue;
+        folded += c.isLetterOrNumber() ? c.toLower() : QChar(' ');
+    }
+    return folded.split(' ', Qt::SkipEmptyParts);
+}
+
+QVector<TaskFilterEngine::Term> TaskFilterEngine::terms(const QString& text) {
+    // Same word split as the FTS query built for the database
+    QVector<Term> result;
+    const QStringList words = text.split(QRegExp("\\s+"), Qt::SkipEmptyParts);
+    for (const QString& word : words) {
+        Term term = fold(word);
+        if (!term.isEmpty()) result.append(term);
+    }
+    return result;
+}
+
+bool TaskFilterEngine::implies(const Term& narrower, const Term& wider) {
+    if (narrower.size() != wider.size()) return false;
+    for (int i = 0; i < wider.size() - 1; ++i) {
+        if (narrower.at(i) != wider.at(i)) return false;
+    }
+    return narrower.last().startsWith(wider.last());
+}
@@ -0,0 +1,65 @@
+#include "taskfilterproxymodel.h"
+#include "taskpagemodel.h"
+
+TaskFilterProxyModel::TaskFilterProxyModel(TaskPageModel* source, QObject* parent)
+    : QSortFilterProxyModel(parent), m_source(source) {
+    // Connected before setSourceModel(), so stale keys are gone by the
+    // time the proxy re-filters changed rows
+    connect(source, &QAbstractItemModel::dataChanged, this,
+            [this](const QModelIndex& topLeft, const QModelIndex& bottomRight) {
+        dropKeys(topLeft.row(), bottomRight.row());
+    });
+    connect(source, &QAbstractItemModel::rowsAboutToBeRemoved, this,
+            [this](const QModelIndex&, int first, int last) {
+        dropKeys(first, last);
+    });
+    connect(source, &QAbstractItemModel::modelAboutToBeReset, this, [this]() {
+        m_keys.clear();
+    });
+    setSourceModel(source);
+}
+
+void TaskFilterProxyModel::setFilter(const Database::TaskFilter& filter) {
+    const Database::TaskFilter& loaded = m_source->filter();
+    const bool allFetched = !m_source->canFetchMore(QModelIndex());
+
+    if (!m_stale && allFetched && TaskFilterEngine::narrows(loaded, filter)) {
+        // Back to exactly what is loaded: no mask needed
+        const bool same = TaskFilterEngine::narrows(filter, loaded);
+        m_engine.setFilter(filter);
+        if (m_masking || !same) {
+            m_masking = !same;
+            invalidateFilter();
+        }
+        return;
+    }
+
+    m_stale = false;
+    m_masking = false;
+    m_source->setFilter(filter);
+}
+
+int TaskFilterProxyModel::matchCount() const {
+    return m_masking ? rowCount() : m_source->totalCount();
+}
+
+bool TaskFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const {
+    Q_UNUSED(sourceParent);
+    if (!m_masking) return true;
+    return m_engine.matches(m_source->taskAt(sourceRow), keyFor(sourceRow));
+}
+
+const QStringList& TaskFilterProxyModel::keyFor(int sourceRow) const {
+    const Task& task = m_source->taskAt(sourceRow);
+    auto it = m_keys.find(task.id);
+    if (it == m_keys.end()) {
+        it = m_keys.insert(task.id, TaskFilterEngine::searchKey(task));
+    }
+    return it.value();
+}
+
+void TaskFilterProxyModel::dropKeys(int first, int last) {
+    for (int row = first; row <= last && row < m_source->rowCount(); ++row) {
+        m_keys.remove(m_source->taskAt(row).id);
+    }
+}
@@ -0,0 +1,65 @@
+#include "taskpagemodel.h"
+
+TaskPageModel::TaskPageModel(const QVector<Column>& columns, QObject* parent)
+    : TaskTableModel(columns, parent) {}
+
+void TaskPageModel::setFilter(const Database::TaskFilter& filter) {
+    m_filter = filter;
+    reload();
+}
+
+void TaskPageModel::reload() {
+    clear();
+    m_lastKey = Database::TaskPageKey();
+    m_totalCount = Database::countTasks(m_filter);
+    m_hasMore = m_totalCount > 0;
+    fetchMore(QModelIndex());
+}
+
+bool TaskPageModel::canFetchMore(const QModelIndex& parent) const {
+    return !parent.isValid() && m_hasMore;
+}
+
+void TaskPageModel::fetchMore(const QModelIndex& parent) {
+    if (parent.isValid() || !m_hasMore) return;
+
+    const QVector<Task> page = Database::getTasksPage(m_lastKey, kPageSize,
+                                                      Database::TaskSort::DeadlineAscending, m_filter);
+    m_hasMore = page.size() == kPageSize;
+    if (page.isEmpty()) return;
+
+    appendTasks(page);
+    m_lastKey.deadline = page.last().deadline;
+    m_lastKey.id = page.last().id;
+}
+
+bool TaskPageModel::applyChange(const Task& before, const Task& after) {
+    if (!m_filter.text.isEmpty()) return false;
+
+    const bool belongs = matches(after);
+    m_totalCount += int(belongs) - int(matches(before));
+
+    const int row = rowOf(before.id != -1 ? before.id : after.id);
+    if (row != -1 && belongs && taskAt(row).deadline == after.deadline) {
+        upsertTask(after);
+        return true;
+    }
+    if (row != -1) removeTaskAt(row);
+    if (!belongs) return true;
+
+    // Rows past the last fetched key arrive with a later page
+    const bool beforeLastKey = after.deadline < m_lastKey.deadline ||
+                               (after.deadline == m_lastKey.deadline && after.id < m_lastKey.id);
+    if (!m_hasMore || beforeLastKey) {
+        insertTaskAt(insertionRow(after), after);
+    }
+    return true;
+}
+
+bool TaskPageModel::matches(const Task& task) const {
+    return task.id != -1 &&
+           (m_filter.priority < 0 || task.priority == m_filter.priority) &&
+           (m_filter.includeCompleted || !task.isCompleted) &&
+           (!m_filter.from.isValid() || task.deadline >= m_filter.from) &&
+           (!m_filter.to.isValid() || task.deadline < m_filter.to);
+}
@@ -0,0 +1,96 @@
+#include "taskstore.h"
+#include "database.h"
+#include "changenotifier.h"
+
+TaskStore::TaskStore(QObject* parent)
+    : QObject(parent) {
+    // Direct for writes on this thread, so the cache is current by the time
+    // the write returns; queued for ones made on the worker thread
+    ChangeNotifier* notifier = ChangeNotifier::instance();
+    connect(notifier, &ChangeNotifier::taskInserted, this, [this](const Task& task) {
+        store(task);
+    });
+    connect(notifier, &ChangeNotifier::taskUpdated, this, [this](const Task&, const Task& after) {
+        store(after);
+    });
+    connect(notifier, &ChangeNotifier::taskDeleted, this, [this](const Task& task) {
+        unindex(task.id);
+    });
+    connect(notifier, &ChangeNotifier::tasksReset, this, &TaskStore::invalidate);
+    connect(notifier, &ChangeNotifier::dataReset, this, &TaskStore::invalidate);
+}
+
+bool TaskStore::createTask(Task& task) {
+    return Database::createTask(task);
+}
+
+bool TaskStore::updateTask(Task& task) {
+    return Database::updateTask(task);
+}
+
+bool TaskStore::deleteTask(int id) {
+    return Database::deleteTask(id);
+}
+
+Task TaskStore::task(int id) {
+    ensureLoaded();
+    return m_byId.value(id);
+}
+
+QVector<Task> TaskStore::allTasks() {
+    ensureLoaded();
+    QVector<Task> tasks;
+    tasks.reserve(m_byId.size());
+    for (auto it = m_byDeadline.constBegin(); it != m_byDeadline.constEnd(); ++it) {
+        tasks.append(m_byId.value(it.value()));
+    }
+    return tasks;
+}
+
+QVector<Task> TaskStore::tasksInRange(const QDateTime& from, const QDateTime& to, bool includeCompleted) {
+    ensureLoaded();
+    QVector<Task> tasks;
+    const QMultiMap<QDateTime, int>& byDeadline = m_byDeadline;
+    for (auto it = byDeadline.lowerBound(from); it != byDeadline.constEnd() && it.key() < to; ++it) {
+        Task task = m_byId.value(it.value());
+        if (!includeCompleted && task.isCompleted) continue;
+        tasks.append(task);
+    }
+    return tasks;
+}
+
+void TaskStore::invalidate() {
+    m_loaded = false;
+    m_byId.clear();
+    m_byDeadline.clear();
+}
+
+void TaskStore::ensureLoaded() {
+    if (m_loaded) return;
+
+    const QVector<Task> tasks = Database::getAllTasks();
+    m_byId.reserve(tasks.size());
+    for (const Task& task : tasks) {
+        index(task);
+    }
+    m_loaded = true;
+}
+
+void TaskStore::store(const Task& task) {
+    if (!m_loaded) return;
+    unindex(task.id);
+    index(task);
+}
+
+void TaskStore::index(const Task& task) {
+    m_byId.insert(task.id, task);
+    m_byDeadline.insert(task.deadline, task.id);
+}
+
+void TaskStore::unindex(int id) {
+    auto it = m_byId.find(id);
+    if (it == m_byId.end()) return;
+    auto byDeadline = m_byDeadline.find(it.value().deadline, id);
+    if (byDeadline != m_byDeadline.end()) m_byDeadline.erase(byDeadline);
+    m_byId.erase(it);
+}
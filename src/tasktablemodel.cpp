@@ -0,0 +1,225 @@
+#include "tasktablemodel.h"
+#include <QBrush>
+#include <QFont>
+#include <algorithm>
+
+namespace {
+    // Shared by every cell; created on first use, after QApplication
+    struct Styles {
+        QBrush overdue{Qt::red};
+        QBrush completed{Qt::gray};
+        QBrush priority[4] = {QBrush(), QBrush(Qt::red), QBrush(QColor(255, 165, 0)), QBrush(Qt::darkRed)};
+        QFont completedFont;
+
+        Styles() { completedFont.setStrikeOut(true); }
+    };
+
+    const Styles& styles() {
+        static const Styles shared;
+        return shared;
+    }
+}
+
+TaskTableModel::TaskTableModel(const QVector<Column>& columns, QObject* parent)
+    : QAbstractTableModel(parent), m_columns(columns) {}
+
+void TaskTableModel::setTasks(const QVector<Task>& tasks, const QVector<Task>& archived) {
+    beginResetModel();
+    m_tasks = tasks;
+    m_tasks += archived;
+    m_archived.clear();
+    for (const Task& task : archived) {
+        m_archived.insert(task.id);
+    }
+    m_rows.clear();
+    m_rows.reserve(m_tasks.size());
+    m_indexedUpTo = 0;
+    indexRowsFrom(0);
+    m_now = QDateTime::currentDateTime();
+    endResetModel();
+}
+
+void TaskTableModel::appendTasks(const QVector<Task>& tasks) {
+    if (tasks.isEmpty()) return;
+    const int first = m_tasks.size();
+    beginInsertRows(QModelIndex(), first, first + tasks.size() - 1);
+    m_tasks += tasks;
+    indexRowsFrom(first);
+    m_now = QDateTime::currentDateTime();
+    endInsertRows();
+}
+
+void TaskTableModel::clear() {
+    setTasks({});
+}
+
+void TaskTableModel::upsertTask(const Task& task, bool belongs) {
+    const int row = rowOf(task.id);
+    if (!belongs) {
+        if (row != -1) removeTaskAt(row);
+        return;
+    }
+
+    if (row != -1 && m_tasks.at(row).deadline == task.deadline) {
+        m_tasks[row] = task;
+        emit dataChanged(index(row, 0), index(row, m_columns.size() - 1));
+        return;
+    }
+
+    if (row != -1) removeTaskAt(row);
+    insertTaskAt(insertionRow(task), task);
+}
+
+bool TaskTableModel::removeTask(int id) {
+    const int row = rowOf(id);
+    if (row == -1) return false;
+    removeTaskAt(row);
+    return true;
+}
+
+int TaskTableModel::insertionRow(const Task& task) const {
+    // Live rows are ordered by (deadline, id); archived ones follow them
+    const auto liveEnd = m_tasks.cend() - m_archived.size();
+    const auto it = std::lower_bound(m_tasks.cbegin(), liveEnd, task, [](const Task& a, const Task& b) {
+        return a.deadline < b.deadline || (a.deadline == b.deadline && a.id < b.id);
+    });
+    return int(it - m_tasks.cbegin());
+}
+
+void TaskTableModel::insertTaskAt(int row, const Task& task) {
+    beginInsertRows(QModelIndex(), row, row);
+    m_tasks.insert(row, task);
+    m_rows.insert(task.id, row);
+    rowsMovedFrom(row + 1);
+    endInsertRows();
+}
+
+void TaskTableModel::removeTaskAt(int row) {
+    beginRemoveRows(QModelIndex(), row, row);
+    const int id = m_tasks.at(row).id;
+    m_archived.remove(id);
+    m_rows.remove(id);
+    m_tasks.remove(row);
+    rowsMovedFrom(row);
+    endRemoveRows();
+}
+
+// Indexes every row from here on; used when rows are loaded
+void TaskTableModel::indexRowsFrom(int row) {
+    const bool contiguous = row <= m_indexedUpTo;
+    for (; row < m_tasks.size(); ++row) {
+        m_rows.insert(m_tasks.at(row).id, row);
+    }
+    if (contiguous) m_indexedUpTo = m_tasks.size();
+}
+
+// Every shown task has an entry, but past m_indexedUpTo it may point at
+// the row the task had before earlier rows were inserted or removed. A
+// stale entry is caught by checking the id at that row, then the rows
+// from m_indexedUpTo are renumbered up to the task's actual row. Inserts
+// and removes touch only their own entry, and a walk never repeats rows
+// that are already indexed, but a lookup far below an edit is still O(n),
+// as is the QVector shift on insert or remove.
+int TaskTableModel::rowOf(int id) const {
+    const auto it = m_rows.constFind(id);
+    if (it == m_rows.constEnd()) return -1;
+    const int row = it.value();
+    if (row < m_tasks.size() && m_tasks.at(row).id == id) return row;
+
+    for (int r = m_indexedUpTo; r < m_tasks.size(); ++r) {
+        const int rowId = m_tasks.at(r).id;
+        m_rows.insert(rowId, r);
+        m_indexedUpTo = r + 1;
+        if (rowId == id) return r;
+    }
+    return -1;
+}
+
+int TaskTableModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : m_tasks.size();
+}
+
+int TaskTableModel::columnCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : m_columns.size();
+}
+
+QVariant TaskTableModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= m_tasks.size()) return QVariant();
+
+    const Task& task = m_tasks.at(index.row());
+    const Styles& style = styles();
+
+    switch (m_columns.at(index.column())) {
+        case Column::Completed:
+            if (role == Qt::CheckStateRole) return task.isCompleted ? Qt::Checked : Qt::Unchecked;
+            if (role == Qt::TextAlignmentRole) return Qt::AlignCenter;
+            break;
+
+        case Column::Title:
+            if (role == Qt::DisplayRole) return task.title;
+            if (role == Qt::FontRole && task.isCompleted) return style.completedFont;
+            if (role == Qt::ForegroundRole) {
+                if (task.isCompleted) return style.completed;
+                if (isOverdue(task)) return style.overdue;
+            }
+            break;
+
+        case Column::Description:
+            if (role == Qt::DisplayRole) {
+                return task.description.length() > 50 ? task.description.left(47) + "..."
+                                                      : task.description;
+            }
+            break;
+
+        case Column::Deadline:
+            if (role == Qt::DisplayRole) return task.deadline.toString("dd/MM/yyyy hh:mm");
+            break;
+
+        case Column::Time:
+            if (role == Qt::DisplayRole) return task.deadline.time().toString("hh:mm");
+            break;
+
+        case Column::Priority:
+            if (role == Qt::DisplayRole) return priorityNames.value(task.priority, "None");
+            if (role == Qt::ForegroundRole && task.priority > 0 && task.priority < 4) {
+                return style.priority[task.priority];
+            }
+            break;
+
+        case Column::Status:
+            if (role == Qt::DisplayRole) return statusOf(task);
+            if (role == Qt::ForegroundRole && isOverdue(task) && !m_archived.contains(task.id)) {
+                return style.overdue;
+            }
+            break;
+    }
+    return QVariant();
+}
+
+QVariant TaskTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole || section >= m_columns.size()) {
+        return QAbstractTableModel::headerData(section, orientation, role);
+    }
+
+    switch (m_columns.at(section)) {
+        case Column::Completed:   return QString();
+        case Column::Title:       return QStringLiteral("Title");
+        case Column::Description: return QStringLiteral("Description");
+        case Column::Deadline:    return QStringLiteral("Deadline");
+        case Column::Time:        return QStringLiteral("Time");
+        case Column::Priority:    return QStringLiteral("Priority");
+        case Column::Status:      return QStringLiteral("Status");
+    }
+    return QVariant();
+}
+
+Qt::ItemFlags TaskTableModel::flags(const QModelIndex& index) const {
+    if (!index.isValid()) return Qt::NoItemFlags;
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemNeverHasChildren;
+}
+
+QString TaskTableModel::statusOf(const Task& task) const {
+    if (m_archived.contains(task.id)) return "Archived";
+    if (task.isCompleted) return "Completed";
+    return isOverdue(task) ? "Overdue" : "Pending";
+}